@@ -3,11 +3,16 @@
 
 #include "smm_api.h"
 #include "../shared_memory_pool/shared_memory_pool.h"
+#include "../shared_memory_pool/arena_pool.h"
 #include "../persistence/persistence.h"
+#include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
+#include <iterator>
 #include <cstring>
 #include <mutex>
+#include <shared_mutex>
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,18 +21,19 @@ extern "C" {
 // 全局错误码（线程局部存储）
 static thread_local SMM_ErrorCode g_last_error = SMM_SUCCESS;
 
-// 句柄到对象的映射（使用互斥锁保护，支持多线程）
+// 句柄到对象的映射（读写锁保护：查找句柄加读锁，创建/销毁加写锁）
 static std::map<SMM_PoolHandle, SharedMemoryPool*> g_pools;
-static std::mutex g_pools_mutex;
+static std::shared_mutex g_pools_mutex;
 
 // 辅助函数：验证句柄
+// 各接口取得内存池后用 SharedLock 加锁，只读接口（读取、查询状态）加读锁，可以多线程并行
 static SharedMemoryPool* GetPool(SMM_PoolHandle handle) {
     if (!handle) {
         g_last_error = SMM_ERROR_INVALID_HANDLE;
         return nullptr;
     }
 
-    std::lock_guard<std::mutex> lock(g_pools_mutex);
+    std::shared_lock<std::shared_mutex> lock(g_pools_mutex);
     auto it = g_pools.find(handle);
     if (it == g_pools.end()) {
         g_last_error = SMM_ERROR_INVALID_HANDLE;
@@ -36,27 +42,107 @@ static SharedMemoryPool* GetPool(SMM_PoolHandle handle) {
     return it->second;
 }
 
+// 多 arena 内存池句柄
+static std::map<SMM_PoolHandle, ArenaPool*> g_arena_pools;
+
+static ArenaPool* GetArenaPool(SMM_PoolHandle handle) {
+    std::shared_lock<std::shared_mutex> lock(g_pools_mutex);
+    auto it = g_arena_pools.find(handle);
+    if (it == g_arena_pools.end()) {
+        g_last_error = SMM_ERROR_INVALID_HANDLE;
+        return nullptr;
+    }
+    return it->second;
+}
+
 // 辅助函数：设置错误码
 static void SetError(SMM_ErrorCode error) {
     g_last_error = error;
 }
 
+// 辅助函数：填写状态信息中按 NUMA 节点的常驻字节数
+static void FillNodeStatus(const std::vector<size_t>& nodeBytes, SMM_StatusInfo* status_out) {
+    static_assert(SMM_MAX_NUMA_NODES == NumaTopology::kMaxNodes, "NUMA node count mismatch");
+    std::fill(std::begin(status_out->node_resident_bytes),
+              std::end(status_out->node_resident_bytes), 0);
+    size_t count = std::min<size_t>(nodeBytes.size(), SMM_MAX_NUMA_NODES);
+    std::copy(nodeBytes.begin(), nodeBytes.begin() + count, status_out->node_resident_bytes);
+    status_out->numa_node_count = NumaTopology::NodeCount();
+}
+
 // 创建内存池
 SMM_PoolHandle smm_create_pool(size_t pool_size) {
+    return smm_create_pool_ex(pool_size, 0);
+}
+
+// 创建内存池（指定块大小）
+SMM_PoolHandle smm_create_pool_ex(size_t pool_size, size_t block_size) {
+    try {
+        if (pool_size == 0) {
+            pool_size = SharedMemoryPool::kDefaultPoolSize;
+        }
+        if (block_size == 0) {
+            block_size = SharedMemoryPool::kDefaultBlockSize;
+        }
+        // 块大小须为 2 的幂，内存池至少容纳一个块
+        if (block_size < SharedMemoryPool::kMinBlockSize || (block_size & (block_size - 1)) != 0 ||
+            pool_size < block_size) {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return nullptr;
+        }
+
+        SharedMemoryPool* pool = new SharedMemoryPool();
+        if (!pool->Init(pool_size, block_size)) {
+            delete pool;
+            SetError(SMM_ERROR_OUT_OF_MEMORY);
+            return nullptr;
+        }
+        // 各接口的修改都在 SharedLock 内进行，smm_read 等读取可以不加锁
+        pool->EnableLockFreeReads();
+
+        SMM_PoolHandle handle = static_cast<SMM_PoolHandle>(pool);
+        std::lock_guard<std::shared_mutex> lock(g_pools_mutex);
+        g_pools[handle] = pool;
+
+        SetError(SMM_SUCCESS);
+        return handle;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return nullptr;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return nullptr;
+    }
+}
+
+// 打开（不存在时创建）跨进程共享内存池
+SMM_PoolHandle smm_open_shared_pool(const char* name, size_t pool_size, size_t block_size) {
     try {
-        // 注意：当前实现固定使用 1GB，pool_size 参数暂时忽略
-        // 后续可以扩展 SharedMemoryPool 支持自定义大小
-        (void)pool_size; // 避免未使用参数警告
+        if (!name || name[0] == '\0') {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return nullptr;
+        }
+        if (pool_size == 0) {
+            pool_size = SharedMemoryPool::kDefaultPoolSize;
+        }
+        if (block_size == 0) {
+            block_size = SharedMemoryPool::kDefaultBlockSize;
+        }
+        if (block_size < SharedMemoryPool::kMinBlockSize || (block_size & (block_size - 1)) != 0 ||
+            pool_size < block_size) {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return nullptr;
+        }
 
         SharedMemoryPool* pool = new SharedMemoryPool();
-        if (!pool->Init()) {
+        if (!pool->InitShared(name, pool_size, block_size)) {
             delete pool;
             SetError(SMM_ERROR_OUT_OF_MEMORY);
             return nullptr;
         }
 
         SMM_PoolHandle handle = static_cast<SMM_PoolHandle>(pool);
-        std::lock_guard<std::mutex> lock(g_pools_mutex);
+        std::lock_guard<std::shared_mutex> lock(g_pools_mutex);
         g_pools[handle] = pool;
 
         SetError(SMM_SUCCESS);
@@ -77,7 +163,7 @@ SMM_ErrorCode smm_destroy_pool(SMM_PoolHandle pool) {
         return SMM_ERROR_INVALID_PARAM;
     }
 
-    std::lock_guard<std::mutex> lock(g_pools_mutex);
+    std::lock_guard<std::shared_mutex> lock(g_pools_mutex);
     auto it = g_pools.find(pool);
     if (it == g_pools.end()) {
         SetError(SMM_ERROR_INVALID_HANDLE);
@@ -97,9 +183,13 @@ SMM_ErrorCode smm_reset_pool(SMM_PoolHandle pool) {
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     try {
-        smp->Reset();
+        if (!smp->Reset()) {
+            SetError(SMM_ERROR_BUSY); // 有活动视图或未提交的预留
+            return SMM_ERROR_BUSY;
+        }
         SetError(SMM_SUCCESS);
         return SMM_SUCCESS;
     } catch (...) {
@@ -115,6 +205,7 @@ SMM_ErrorCode smm_alloc(SMM_PoolHandle pool, const char* description, const void
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     if (!description || !data || !memory_id_out) {
         SetError(SMM_ERROR_INVALID_PARAM);
@@ -162,6 +253,7 @@ SMM_ErrorCode smm_free(SMM_PoolHandle pool, const char* memory_id) {
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     if (!memory_id) {
         SetError(SMM_ERROR_INVALID_PARAM);
@@ -169,7 +261,12 @@ SMM_ErrorCode smm_free(SMM_PoolHandle pool, const char* memory_id) {
     }
 
     try {
-        if (!smp->FreeByMemoryId(std::string(memory_id))) {
+        std::string mem_id(memory_id);
+        if (smp->GetViewCount(mem_id) > 0) {
+            SetError(SMM_ERROR_BUSY);
+            return SMM_ERROR_BUSY;
+        }
+        if (!smp->FreeByMemoryId(mem_id)) {
             SetError(SMM_ERROR_NOT_FOUND);
             return SMM_ERROR_NOT_FOUND;
         }
@@ -189,6 +286,7 @@ SMM_ErrorCode smm_update(SMM_PoolHandle pool, const char* memory_id, const void*
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     if (!memory_id || !new_data) {
         SetError(SMM_ERROR_INVALID_PARAM);
@@ -204,22 +302,17 @@ SMM_ErrorCode smm_update(SMM_PoolHandle pool, const char* memory_id, const void*
         std::string mem_id(memory_id);
 
         // 检查 Memory ID 是否存在
-        const auto& memoryInfo = smp->GetMemoryInfo();
-        auto it = memoryInfo.find(mem_id);
-        if (it == memoryInfo.end()) {
+        if (!smp->FindMemory(mem_id)) {
             SetError(SMM_ERROR_NOT_FOUND);
             return SMM_ERROR_NOT_FOUND;
         }
 
-        // 获取当前描述
-        const auto& meta = smp->GetMeta(it->second.first);
-        std::string description = meta.description;
-
-        // 释放旧内存
-        smp->FreeByMemoryId(mem_id);
-
-        // 分配新内存
-        int result = smp->AllocateBlock(mem_id, description, new_data, new_data_size);
+        // 原地覆盖/原地扩展，都不行时才搬到新位置（空间不足时原内容保持不变）
+        int result = smp->Update(mem_id, new_data, new_data_size);
+        if (result < 0 && smp->GetViewCount(mem_id) > 0) {
+            SetError(SMM_ERROR_BUSY); // 有活动视图时只能原位覆盖
+            return SMM_ERROR_BUSY;
+        }
         if (result < 0) {
             SetError(SMM_ERROR_OUT_OF_MEMORY);
             return SMM_ERROR_OUT_OF_MEMORY;
@@ -250,24 +343,13 @@ SMM_ErrorCode smm_read(SMM_PoolHandle pool, const char* memory_id, void* buffer,
     }
 
     try {
-        std::string content = smp->GetMemoryContentAsString(std::string(memory_id));
-        if (content.empty()) {
-            // 检查是否存在
-            const auto& memoryInfo = smp->GetMemoryInfo();
-            if (memoryInfo.find(std::string(memory_id)) == memoryInfo.end()) {
-                SetError(SMM_ERROR_NOT_FOUND);
-                return SMM_ERROR_NOT_FOUND;
-            }
-            // 存在但内容为空
-            *actual_size = 0;
-            SetError(SMM_SUCCESS);
-            return SMM_SUCCESS;
+        // 按记录的字节数直接从内存池复制到缓冲区（内容中可以包含 0），启用无锁读取时不加锁
+        size_t length = 0;
+        if (!smp->ReadMemory(std::string(memory_id), buffer, buffer_size, length)) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
         }
-
-        // 复制内容到缓冲区
-        size_t copy_size = (content.size() < buffer_size) ? content.size() : buffer_size;
-        std::memcpy(buffer, content.data(), copy_size);
-        *actual_size = copy_size;
+        *actual_size = (length < buffer_size) ? length : buffer_size;
 
         // 如果缓冲区太小，仍然返回成功，但 actual_size 会小于实际大小
         SetError(SMM_SUCCESS);
@@ -278,12 +360,166 @@ SMM_ErrorCode smm_read(SMM_PoolHandle pool, const char* memory_id, void* buffer,
     }
 }
 
+// 取得视图（直接指向内存池中的内容）
+SMM_ErrorCode smm_acquire_view(SMM_PoolHandle pool, const char* memory_id, const void** data_out,
+                               size_t* size_out, SMM_ViewLease* lease_out) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    if (!memory_id || !data_out || !size_out || !lease_out) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+    if (smp->IsShared()) {
+        SetError(SMM_ERROR_INVALID_HANDLE);
+        return SMM_ERROR_INVALID_HANDLE;
+    }
+
+    try {
+        SharedMemoryPool::SharedLock shared_lock(*smp, SharedMemoryPool::SharedLock::Mode::kRead);
+        SharedMemoryPool::MemoryView view;
+        if (!smp->AcquireView(std::string(memory_id), view)) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
+        }
+        *data_out = view.data;
+        *size_out = view.length;
+        *lease_out = view.lease;
+
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return SMM_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 预留内存（调用方直接写入）
+SMM_ErrorCode smm_reserve(SMM_PoolHandle pool, size_t size, const char* description,
+                          void** data_out, SMM_ReserveTicket* ticket_out) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    if (!description || !data_out || !ticket_out || size == 0) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+    if (smp->IsShared()) {
+        SetError(SMM_ERROR_INVALID_HANDLE);
+        return SMM_ERROR_INVALID_HANDLE;
+    }
+
+    try {
+        SharedMemoryPool::SharedLock shared_lock(*smp);
+        uint8_t* data = nullptr;
+        uint64_t ticket = 0;
+        if (!smp->Reserve(size, std::string(description), data, ticket)) {
+            SetError(SMM_ERROR_OUT_OF_MEMORY);
+            return SMM_ERROR_OUT_OF_MEMORY;
+        }
+        *data_out = data;
+        *ticket_out = ticket;
+
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return SMM_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 提交预留的内存（生成 memory_id，之后对读者可见）
+SMM_ErrorCode smm_commit(SMM_PoolHandle pool, SMM_ReserveTicket ticket, size_t actual_size,
+                         char* memory_id_out, size_t memory_id_size) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    if (!memory_id_out || memory_id_size == 0) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        SharedMemoryPool::SharedLock shared_lock(*smp);
+        // 先检查票据（票据不存在，或 actual_size 为 0 / 超过预留的大小），合法时才生成 ID
+        if (!smp->CanCommit(ticket, actual_size)) {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return SMM_ERROR_INVALID_PARAM;
+        }
+        std::string memory_id = smp->GenerateNextMemoryId();
+        if (memory_id.size() >= memory_id_size || smp->Commit(ticket, memory_id, actual_size) < 0) {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return SMM_ERROR_INVALID_PARAM;
+        }
+        std::strncpy(memory_id_out, memory_id.c_str(), memory_id_size - 1);
+        memory_id_out[memory_id_size - 1] = '\0';
+
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return SMM_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 放弃预留的内存
+SMM_ErrorCode smm_abort(SMM_PoolHandle pool, SMM_ReserveTicket ticket) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    try {
+        SharedMemoryPool::SharedLock shared_lock(*smp);
+        if (!smp->Abort(ticket)) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
+        }
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 释放视图（不需要内存池锁）
+SMM_ErrorCode smm_release_view(SMM_PoolHandle pool, SMM_ViewLease lease) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    if (!smp->ReleaseView(lease)) {
+        SetError(SMM_ERROR_NOT_FOUND);
+        return SMM_ERROR_NOT_FOUND;
+    }
+    SetError(SMM_SUCCESS);
+    return SMM_SUCCESS;
+}
+
 // 获取状态信息
 SMM_ErrorCode smm_get_status(SMM_PoolHandle pool, SMM_StatusInfo* status_out) {
     SharedMemoryPool* smp = GetPool(pool);
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp, SharedMemoryPool::SharedLock::Mode::kRead);
 
     if (!status_out) {
         SetError(SMM_ERROR_INVALID_PARAM);
@@ -291,17 +527,26 @@ SMM_ErrorCode smm_get_status(SMM_PoolHandle pool, SMM_StatusInfo* status_out) {
     }
 
     try {
-        const auto& memoryInfo = smp->GetMemoryInfo();
-        size_t total_blocks = SharedMemoryPool::kBlockCount;
+        size_t total_blocks = smp->GetBlockCount();
         size_t free_blocks = smp->GetFreeBlockCount();
         size_t used_blocks = total_blocks - free_blocks;
 
         status_out->total_blocks = total_blocks;
         status_out->free_blocks = free_blocks;
         status_out->used_blocks = used_blocks;
-        status_out->allocated_count = memoryInfo.size();
-        status_out->pool_size = SharedMemoryPool::kPoolSize;
-        status_out->block_size = SharedMemoryPool::kBlockSize;
+        status_out->allocated_count = smp->GetAllocationCount();
+        status_out->pool_size = smp->GetPoolSize();
+        status_out->block_size = smp->GetBlockSize();
+        status_out->resident_bytes = smp->GetResidentBytes();
+        status_out->logical_bytes = smp->GetLogicalBytes();
+        static_assert(SMM_FREE_RUN_BUCKETS == FreeSpaceBitmap::kRunBucketCount,
+                      "free run histogram size mismatch");
+        SharedMemoryPool::FragmentationStats frag = smp->GetFragmentationStats();
+        status_out->free_fragment_count = frag.fragment_count;
+        status_out->largest_free_run = frag.largest_free_run;
+        std::copy(frag.run_histogram.begin(), frag.run_histogram.end(),
+                  status_out->free_run_histogram);
+        FillNodeStatus(smp->GetResidentBytesByNode(), status_out);
 
         SetError(SMM_SUCCESS);
         return SMM_SUCCESS;
@@ -325,10 +570,10 @@ SMM_ErrorCode smm_get_memory_info(SMM_PoolHandle pool, const char* memory_id,
     }
 
     try {
+        // 只读取记录信息（启用无锁读取时不加锁）
         std::string mem_id(memory_id);
-        const auto& memoryInfo = smp->GetMemoryInfo();
-        auto it = memoryInfo.find(mem_id);
-        if (it == memoryInfo.end()) {
+        SharedMemoryPool::MemorySnapshot snapshot;
+        if (!smp->ReadMemorySnapshot(mem_id, snapshot, false)) {
             SetError(SMM_ERROR_NOT_FOUND);
             return SMM_ERROR_NOT_FOUND;
         }
@@ -338,18 +583,26 @@ SMM_ErrorCode smm_get_memory_info(SMM_PoolHandle pool, const char* memory_id,
         info_out->memory_id[sizeof(info_out->memory_id) - 1] = '\0';
 
         // 获取描述
-        const auto& meta = smp->GetMeta(it->second.first);
-        std::strncpy(info_out->description, meta.description.c_str(),
+        const std::string& description = snapshot.description;
+        std::strncpy(info_out->description, description.c_str(),
                      sizeof(info_out->description) - 1);
         info_out->description[sizeof(info_out->description) - 1] = '\0';
 
         // 设置块信息
-        info_out->start_block = it->second.first;
-        info_out->block_count = it->second.second;
-        info_out->data_size = it->second.second * SharedMemoryPool::kBlockSize;
+        info_out->start_block = snapshot.start_block;
+        info_out->block_count = snapshot.block_count;
+        info_out->data_size = snapshot.byte_length;
 
         // 获取最后修改时间
-        info_out->last_modified = smp->GetMemoryLastModifiedTime(mem_id);
+        info_out->last_modified = snapshot.last_modified;
+
+        // 有视图时才加读锁查询视图数
+        info_out->active_views = 0;
+        if (smp->GetActiveViewCount() > 0) {
+            SharedMemoryPool::SharedLock shared_lock(*smp,
+                                                     SharedMemoryPool::SharedLock::Mode::kRead);
+            info_out->active_views = smp->GetViewCount(mem_id);
+        }
 
         SetError(SMM_SUCCESS);
         return SMM_SUCCESS;
@@ -365,6 +618,7 @@ SMM_ErrorCode smm_compact(SMM_PoolHandle pool) {
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     try {
         smp->Compact();
@@ -376,12 +630,358 @@ SMM_ErrorCode smm_compact(SMM_PoolHandle pool) {
     }
 }
 
+// 增量紧凑
+SMM_ErrorCode smm_compact_step(SMM_PoolHandle pool, unsigned int budget_us, int* finished_out) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
+
+    try {
+        bool finished = smp->CompactFor(std::chrono::microseconds(budget_us));
+        if (finished_out) {
+            *finished_out = finished ? 1 : 0;
+        }
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 启动后台紧凑
+SMM_ErrorCode smm_start_background_compaction(SMM_PoolHandle pool, unsigned int high_percent,
+                                              unsigned int low_percent) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+    if (high_percent == 0 || high_percent > 100 || low_percent >= high_percent) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        BackgroundCompactor::Settings settings;
+        settings.high_watermark = high_percent / 100.0;
+        settings.low_watermark = low_percent / 100.0;
+        smp->StartBackgroundCompaction(settings);
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 停止后台紧凑（等待后台线程退出，不能持有内存池锁）
+SMM_ErrorCode smm_stop_background_compaction(SMM_PoolHandle pool) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+
+    try {
+        smp->StopBackgroundCompaction();
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 设置物理内存归还阈值
+SMM_ErrorCode smm_set_release_threshold(SMM_PoolHandle pool, size_t threshold) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
+
+    smp->SetReleaseThreshold(threshold);
+    SetError(SMM_SUCCESS);
+    return SMM_SUCCESS;
+}
+
+// 归还所有空闲块的物理页
+SMM_ErrorCode smm_release_free_memory(SMM_PoolHandle pool) {
+    SharedMemoryPool* smp = GetPool(pool);
+    if (!smp) {
+        return g_last_error;
+    }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
+
+    try {
+        smp->ReleaseFreeMemory();
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 创建多 arena 内存池
+SMM_PoolHandle smm_create_arena_pool(size_t arena_count, size_t arena_size,
+                                     size_t large_arena_size, size_t large_threshold) {
+    try {
+        ArenaPool::Settings settings;
+        settings.arena_count = arena_count;
+        if (arena_size > 0) {
+            settings.arena_size = arena_size;
+        }
+        settings.large_arena_size = large_arena_size;
+        if (large_threshold > 0) {
+            settings.large_threshold = large_threshold;
+        }
+        if (settings.arena_size < settings.block_size ||
+            (large_arena_size > 0 && large_arena_size < settings.block_size)) {
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return nullptr;
+        }
+
+        ArenaPool* pool = new ArenaPool();
+        if (!pool->Init(settings)) {
+            delete pool;
+            SetError(SMM_ERROR_OUT_OF_MEMORY);
+            return nullptr;
+        }
+
+        SMM_PoolHandle handle = static_cast<SMM_PoolHandle>(pool);
+        std::lock_guard<std::shared_mutex> lock(g_pools_mutex);
+        g_arena_pools[handle] = pool;
+
+        SetError(SMM_SUCCESS);
+        return handle;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return nullptr;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return nullptr;
+    }
+}
+
+// 销毁多 arena 内存池
+SMM_ErrorCode smm_destroy_arena_pool(SMM_PoolHandle pool) {
+    if (!pool) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::shared_mutex> lock(g_pools_mutex);
+    auto it = g_arena_pools.find(pool);
+    if (it == g_arena_pools.end()) {
+        SetError(SMM_ERROR_INVALID_HANDLE);
+        return SMM_ERROR_INVALID_HANDLE;
+    }
+
+    delete it->second;
+    g_arena_pools.erase(it);
+
+    SetError(SMM_SUCCESS);
+    return SMM_SUCCESS;
+}
+
+// 绑定调用线程使用的 arena
+SMM_ErrorCode smm_arena_bind_thread(SMM_PoolHandle pool, int arena_index) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (arena_index >= static_cast<int>(arenas->GetNormalArenaCount())) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+    ArenaPool::SetThreadArena(arena_index < 0 ? ArenaPool::npos
+                                              : static_cast<size_t>(arena_index));
+    SetError(SMM_SUCCESS);
+    return SMM_SUCCESS;
+}
+
+size_t smm_get_numa_node_count(void) {
+    return NumaTopology::NodeCount();
+}
+
+// 固定调用线程到 NUMA 节点
+SMM_ErrorCode smm_pin_thread_to_node(int node) {
+    if (node < 0 || static_cast<size_t>(node) >= NumaTopology::NodeCount()) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+    if (!NumaTopology::PinThreadToNode(static_cast<size_t>(node))) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+    SetError(SMM_SUCCESS);
+    return SMM_SUCCESS;
+}
+
+// 在多 arena 内存池中分配（各 arena 分别加锁，不持有全局锁）
+SMM_ErrorCode smm_arena_alloc(SMM_PoolHandle pool, const char* description, const void* data,
+                              size_t data_size, char* memory_id_out, size_t memory_id_size) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (!description || !data || !memory_id_out || data_size == 0) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::string memory_id = arenas->Allocate(description, data, data_size);
+        if (memory_id.empty()) {
+            SetError(SMM_ERROR_OUT_OF_MEMORY);
+            return SMM_ERROR_OUT_OF_MEMORY;
+        }
+        if (memory_id.size() >= memory_id_size) {
+            arenas->Free(memory_id);
+            SetError(SMM_ERROR_INVALID_PARAM);
+            return SMM_ERROR_INVALID_PARAM;
+        }
+        std::memcpy(memory_id_out, memory_id.c_str(), memory_id.size() + 1);
+
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return SMM_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 在多 arena 内存池中释放
+SMM_ErrorCode smm_arena_free(SMM_PoolHandle pool, const char* memory_id) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (!memory_id) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        if (!arenas->Free(memory_id)) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
+        }
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 在多 arena 内存池中更新（在所属 arena 内进行，Memory ID 不变）
+SMM_ErrorCode smm_arena_update(SMM_PoolHandle pool, const char* memory_id, const void* new_data,
+                               size_t new_data_size) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (!memory_id || !new_data || new_data_size == 0) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        if (arenas->FindArena(memory_id) == ArenaPool::npos) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
+        }
+        if (!arenas->Update(memory_id, new_data, new_data_size)) {
+            SetError(SMM_ERROR_OUT_OF_MEMORY);
+            return SMM_ERROR_OUT_OF_MEMORY;
+        }
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        SetError(SMM_ERROR_OUT_OF_MEMORY);
+        return SMM_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 在多 arena 内存池中读取
+SMM_ErrorCode smm_arena_read(SMM_PoolHandle pool, const char* memory_id, void* buffer,
+                             size_t buffer_size, size_t* actual_size) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (!memory_id || !buffer || !actual_size) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        std::string content;
+        if (!arenas->Read(memory_id, content)) {
+            SetError(SMM_ERROR_NOT_FOUND);
+            return SMM_ERROR_NOT_FOUND;
+        }
+        size_t copy_size = (content.size() < buffer_size) ? content.size() : buffer_size;
+        std::memcpy(buffer, content.data(), copy_size);
+        *actual_size = copy_size;
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
+// 多 arena 内存池的合计状态
+SMM_ErrorCode smm_arena_get_status(SMM_PoolHandle pool, SMM_StatusInfo* status_out) {
+    ArenaPool* arenas = GetArenaPool(pool);
+    if (!arenas) {
+        return g_last_error;
+    }
+    if (!status_out) {
+        SetError(SMM_ERROR_INVALID_PARAM);
+        return SMM_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        ArenaPool::Status status = arenas->GetStatus();
+        status_out->total_blocks = status.total_blocks;
+        status_out->free_blocks = status.free_blocks;
+        status_out->used_blocks = status.total_blocks - status.free_blocks;
+        status_out->allocated_count = status.allocated_count;
+        status_out->pool_size = status.pool_size;
+        status_out->block_size = arenas->GetArena(0).GetBlockSize();
+        status_out->resident_bytes = status.resident_bytes;
+        status_out->logical_bytes = status_out->used_blocks * status_out->block_size;
+        status_out->free_fragment_count = status.fragmentation.fragment_count;
+        status_out->largest_free_run = status.fragmentation.largest_free_run;
+        std::copy(status.fragmentation.run_histogram.begin(),
+                  status.fragmentation.run_histogram.end(), status_out->free_run_histogram);
+        FillNodeStatus(status.node_resident_bytes, status_out);
+        SetError(SMM_SUCCESS);
+        return SMM_SUCCESS;
+    } catch (...) {
+        SetError(SMM_ERROR_UNKNOWN);
+        return SMM_ERROR_UNKNOWN;
+    }
+}
+
 // 保存到文件
 SMM_ErrorCode smm_save(SMM_PoolHandle pool, const char* filename) {
     SharedMemoryPool* smp = GetPool(pool);
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     if (!filename) {
         SetError(SMM_ERROR_INVALID_PARAM);
@@ -408,12 +1008,18 @@ SMM_ErrorCode smm_load(SMM_PoolHandle pool, const char* filename) {
     if (!smp) {
         return g_last_error;
     }
+    SharedMemoryPool::SharedLock shared_lock(*smp);
 
     if (!filename) {
         SetError(SMM_ERROR_INVALID_PARAM);
         return SMM_ERROR_INVALID_PARAM;
     }
 
+    if (smp->HasExternalReferences()) {
+        SetError(SMM_ERROR_BUSY); // 有活动视图或未提交的预留
+        return SMM_ERROR_BUSY;
+    }
+
     try {
         if (Persistence::Load(*smp, std::string(filename))) {
             SetError(SMM_SUCCESS);
@@ -450,6 +1056,8 @@ const char* smm_get_error_string(SMM_ErrorCode error) {
         return "Already exists";
     case SMM_ERROR_IO_FAILED:
         return "I/O operation failed";
+    case SMM_ERROR_BUSY:
+        return "Memory is in use by a view or reservation";
     case SMM_ERROR_UNKNOWN:
     default:
         return "Unknown error";
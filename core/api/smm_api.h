@@ -12,6 +12,15 @@ extern "C" {
 
 // 类型定义
 typedef void* SMM_PoolHandle;
+// 视图租约（smm_acquire_view 返回，smm_release_view 释放）
+typedef unsigned long long SMM_ViewLease;
+// 两阶段分配票据（smm_reserve 返回，smm_commit / smm_abort 使用）
+typedef unsigned long long SMM_ReserveTicket;
+
+// 空闲区间直方图的桶数（第 i 桶：长度在 [2^i, 2^(i+1)) 块之间的空闲区间）
+#define SMM_FREE_RUN_BUCKETS 32
+// 状态信息中按 NUMA 节点统计的最大节点数
+#define SMM_MAX_NUMA_NODES 64
 
 // 状态信息结构
 typedef struct {
@@ -21,6 +30,13 @@ typedef struct {
     size_t allocated_count; // 已分配的内存项数量
     size_t pool_size;       // 内存池总大小（字节）
     size_t block_size;      // 块大小（字节）
+    size_t resident_bytes;  // 常驻物理内存（已写入且未归还的块，字节）
+    size_t logical_bytes;   // 逻辑使用量（已分配的块，字节）
+    size_t free_fragment_count;                      // 空闲区间（碎片）数量
+    size_t largest_free_run;                         // 最大连续空闲块数
+    size_t free_run_histogram[SMM_FREE_RUN_BUCKETS]; // 空闲区间长度分布
+    size_t numa_node_count;                          // NUMA 节点数量（单节点为 1）
+    size_t node_resident_bytes[SMM_MAX_NUMA_NODES];  // 常驻物理内存按节点的分布（字节）
 } SMM_StatusInfo;
 
 // 内存信息结构
@@ -31,6 +47,7 @@ typedef struct {
     size_t block_count;    // 块数量
     size_t data_size;      // 实际数据大小（字节）
     time_t last_modified;  // 最后修改时间（Unix时间戳）
+    size_t active_views;   // 活动视图数
 } SMM_MemoryInfo;
 
 // 错误码
@@ -42,6 +59,7 @@ typedef enum {
     SMM_ERROR_NOT_FOUND = -4,
     SMM_ERROR_ALREADY_EXISTS = -5,
     SMM_ERROR_IO_FAILED = -6,
+    SMM_ERROR_BUSY = -7, // 有活动视图（不能释放、搬迁、重置或加载）或未提交的预留（不能重置或加载）
     SMM_ERROR_UNKNOWN = -99
 } SMM_ErrorCode;
 
@@ -58,7 +76,13 @@ typedef enum {
 #endif
 
 // 生命周期管理
+// pool_size 为 0 时使用默认大小（1GB），块大小默认 4KB
 SMM_API SMM_PoolHandle smm_create_pool(size_t pool_size);
+// 指定块大小（须为 2 的幂且不小于 1KB），pool_size/block_size 为 0 时使用默认值
+SMM_API SMM_PoolHandle smm_create_pool_ex(size_t pool_size, size_t block_size);
+// 打开（不存在时创建）名为 name 的跨进程共享内存池，已存在时使用其规格
+// 同名内存池在各进程中看到相同的数据和 Memory ID；最后一个打开它的进程销毁内存池后段名被删除
+SMM_API SMM_PoolHandle smm_open_shared_pool(const char* name, size_t pool_size, size_t block_size);
 SMM_API SMM_ErrorCode smm_destroy_pool(SMM_PoolHandle pool);
 SMM_API SMM_ErrorCode smm_reset_pool(SMM_PoolHandle pool);
 
@@ -70,6 +94,24 @@ SMM_API SMM_ErrorCode smm_update(SMM_PoolHandle pool, const char* memory_id, con
                                  size_t new_data_size);
 SMM_API SMM_ErrorCode smm_read(SMM_PoolHandle pool, const char* memory_id, void* buffer,
                                size_t buffer_size, size_t* actual_size);
+// 视图：data_out 直接指向内存池中的内容（不复制，只读），size_out 为内容字节数。
+// 释放之前这条分配不会被紧凑搬走；smm_free 返回 SMM_ERROR_BUSY，smm_update 只能原位覆盖
+// （块数或小对象级别不变），否则返回 SMM_ERROR_BUSY；smm_reset_pool / smm_load 也返回
+// SMM_ERROR_BUSY。销毁内存池前须全部释放。共享内存池不支持（返回 SMM_ERROR_INVALID_HANDLE）
+SMM_API SMM_ErrorCode smm_acquire_view(SMM_PoolHandle pool, const char* memory_id,
+                                       const void** data_out, size_t* size_out,
+                                       SMM_ViewLease* lease_out);
+SMM_API SMM_ErrorCode smm_release_view(SMM_PoolHandle pool, SMM_ViewLease lease);
+// 两阶段分配：smm_reserve 预留至少 size 字节，data_out 为可以直接写入的地址（不需要先准备
+// 单独的缓冲区）；写完后 smm_commit 提交前 actual_size（1 到 size）字节并返回 memory_id，
+// 提交之前其他调用方看不到这条分配；不再需要时 smm_abort 归还。预留的区间不会被紧凑搬走，
+// 有未提交的预留时 smm_reset_pool / smm_load 返回 SMM_ERROR_BUSY。
+// 共享内存池不支持（返回 SMM_ERROR_INVALID_HANDLE）
+SMM_API SMM_ErrorCode smm_reserve(SMM_PoolHandle pool, size_t size, const char* description,
+                                  void** data_out, SMM_ReserveTicket* ticket_out);
+SMM_API SMM_ErrorCode smm_commit(SMM_PoolHandle pool, SMM_ReserveTicket ticket,
+                                 size_t actual_size, char* memory_id_out, size_t memory_id_size);
+SMM_API SMM_ErrorCode smm_abort(SMM_PoolHandle pool, SMM_ReserveTicket ticket);
 
 // 查询操作
 SMM_API SMM_ErrorCode smm_get_status(SMM_PoolHandle pool, SMM_StatusInfo* status_out);
@@ -78,6 +120,44 @@ SMM_API SMM_ErrorCode smm_get_memory_info(SMM_PoolHandle pool, const char* memor
 
 // 紧凑操作
 SMM_API SMM_ErrorCode smm_compact(SMM_PoolHandle pool);
+// 增量紧凑：在 budget_us 微秒内移动一部分分配后返回（至少移动一个分配），
+// finished_out（可为 NULL）为 1 表示本轮紧凑已完成
+SMM_API SMM_ErrorCode smm_compact_step(SMM_PoolHandle pool, unsigned int budget_us,
+                                       int* finished_out);
+// 后台紧凑：碎片率（1 - 最大连续空闲块 / 总空闲块）达到 high_percent% 时在后台线程中分步紧凑，
+// 降到 low_percent% 以下时停止；启用后其他接口可以在多个线程中同时调用
+SMM_API SMM_ErrorCode smm_start_background_compaction(SMM_PoolHandle pool,
+                                                      unsigned int high_percent,
+                                                      unsigned int low_percent);
+SMM_API SMM_ErrorCode smm_stop_background_compaction(SMM_PoolHandle pool);
+
+// 物理内存归还（释放的连续区间不小于 threshold 字节时归还物理页，0 表示不归还）
+SMM_API SMM_ErrorCode smm_set_release_threshold(SMM_PoolHandle pool, size_t threshold);
+SMM_API SMM_ErrorCode smm_release_free_memory(SMM_PoolHandle pool);
+
+// 多 arena 内存池：分成多个独立加锁的 arena，不同线程的分配/释放可以并行执行
+// arena_count 为 0 时按 CPU 核数；large_arena_size 不为 0 时额外创建大分配 arena，
+// 不小于 large_threshold 字节的分配优先放入其中（large_threshold 为 0 时使用默认值 1MB）
+// 句柄只能用于 smm_arena_* 接口
+SMM_API SMM_PoolHandle smm_create_arena_pool(size_t arena_count, size_t arena_size,
+                                             size_t large_arena_size, size_t large_threshold);
+SMM_API SMM_ErrorCode smm_destroy_arena_pool(SMM_PoolHandle pool);
+// 把调用线程绑定到第 arena_index 个 arena（-1 表示恢复按线程 ID 哈希）
+SMM_API SMM_ErrorCode smm_arena_bind_thread(SMM_PoolHandle pool, int arena_index);
+// NUMA：多节点时普通 arena 轮流放到各节点，未绑定 arena 的线程使用当前所在节点上的 arena
+// smm_pin_thread_to_node 把调用线程固定到节点的 CPU 上（单节点时不做任何事）
+SMM_API size_t smm_get_numa_node_count(void);
+SMM_API SMM_ErrorCode smm_pin_thread_to_node(int node);
+SMM_API SMM_ErrorCode smm_arena_alloc(SMM_PoolHandle pool, const char* description,
+                                      const void* data, size_t data_size, char* memory_id_out,
+                                      size_t memory_id_size);
+SMM_API SMM_ErrorCode smm_arena_free(SMM_PoolHandle pool, const char* memory_id);
+SMM_API SMM_ErrorCode smm_arena_update(SMM_PoolHandle pool, const char* memory_id,
+                                       const void* new_data, size_t new_data_size);
+SMM_API SMM_ErrorCode smm_arena_read(SMM_PoolHandle pool, const char* memory_id, void* buffer,
+                                     size_t buffer_size, size_t* actual_size);
+// 各 arena 的合计状态
+SMM_API SMM_ErrorCode smm_arena_get_status(SMM_PoolHandle pool, SMM_StatusInfo* status_out);
 
 // 持久化
 SMM_API SMM_ErrorCode smm_save(SMM_PoolHandle pool, const char* filename);
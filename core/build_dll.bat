@@ -27,7 +27,7 @@ echo Using: "%GPP%"
 
 REM Define compile options
 set "INCLUDES=-Iapi -Ishared_memory_pool -Ipersistence"
-set "SOURCES=api/smm_api.cpp shared_memory_pool/shared_memory_pool.cpp persistence/persistence.cpp"
+set "SOURCES=api/smm_api.cpp shared_memory_pool/shared_memory_pool.cpp shared_memory_pool/free_space_bitmap.cpp shared_memory_pool/free_extent_index.cpp shared_memory_pool/tlsf_index.cpp shared_memory_pool/slab_allocator.cpp shared_memory_pool/page_memory.cpp shared_memory_pool/shared_segment.cpp shared_memory_pool/background_compactor.cpp shared_memory_pool/memory_id_index.cpp shared_memory_pool/arena_pool.cpp shared_memory_pool/epoch_reclaimer.cpp shared_memory_pool/read_index.cpp shared_memory_pool/block_run_cache.cpp shared_memory_pool/numa_topology.cpp persistence/persistence.cpp"
 set "DLL_NAME=..\sdk\lib\smm.dll"
 set "LIB_NAME=..\sdk\lib\smm.lib"
 set "STATIC_LIB=..\sdk\lib\libsmm.a"
@@ -59,6 +59,84 @@ if errorlevel 1 (
   pause
   exit /b 1
 )
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/free_space_bitmap.cpp -o shared_memory_pool/free_space_bitmap.o
+if errorlevel 1 (
+  echo Failed to compile free_space_bitmap.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/free_extent_index.cpp -o shared_memory_pool/free_extent_index.o
+if errorlevel 1 (
+  echo Failed to compile free_extent_index.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/tlsf_index.cpp -o shared_memory_pool/tlsf_index.o
+if errorlevel 1 (
+  echo Failed to compile tlsf_index.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/slab_allocator.cpp -o shared_memory_pool/slab_allocator.o
+if errorlevel 1 (
+  echo Failed to compile slab_allocator.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/page_memory.cpp -o shared_memory_pool/page_memory.o
+if errorlevel 1 (
+  echo Failed to compile page_memory.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/shared_segment.cpp -o shared_memory_pool/shared_segment.o
+if errorlevel 1 (
+  echo Failed to compile shared_segment.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/background_compactor.cpp -o shared_memory_pool/background_compactor.o
+if errorlevel 1 (
+  echo Failed to compile background_compactor.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/memory_id_index.cpp -o shared_memory_pool/memory_id_index.o
+if errorlevel 1 (
+  echo Failed to compile memory_id_index.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/arena_pool.cpp -o shared_memory_pool/arena_pool.o
+if errorlevel 1 (
+  echo Failed to compile arena_pool.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/epoch_reclaimer.cpp -o shared_memory_pool/epoch_reclaimer.o
+if errorlevel 1 (
+  echo Failed to compile epoch_reclaimer.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/read_index.cpp -o shared_memory_pool/read_index.o
+if errorlevel 1 (
+  echo Failed to compile read_index.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/block_run_cache.cpp -o shared_memory_pool/block_run_cache.o
+if errorlevel 1 (
+  echo Failed to compile block_run_cache.cpp
+  pause
+  exit /b 1
+)
+"%GPP%" -std=c++17 -c %INCLUDES% shared_memory_pool/numa_topology.cpp -o shared_memory_pool/numa_topology.o
+if errorlevel 1 (
+  echo Failed to compile numa_topology.cpp
+  pause
+  exit /b 1
+)
 "%GPP%" -std=c++17 -c %INCLUDES% persistence/persistence.cpp -o persistence/persistence.o
 if errorlevel 1 (
   echo Failed to compile persistence.cpp
@@ -66,7 +144,7 @@ if errorlevel 1 (
   exit /b 1
 )
 
-ar rcs %STATIC_LIB% api/smm_api.o shared_memory_pool/shared_memory_pool.o persistence/persistence.o
+ar rcs %STATIC_LIB% api/smm_api.o shared_memory_pool/shared_memory_pool.o shared_memory_pool/free_space_bitmap.o shared_memory_pool/free_extent_index.o shared_memory_pool/tlsf_index.o shared_memory_pool/slab_allocator.o shared_memory_pool/page_memory.o shared_memory_pool/shared_segment.o shared_memory_pool/background_compactor.o shared_memory_pool/memory_id_index.o shared_memory_pool/arena_pool.o shared_memory_pool/epoch_reclaimer.o shared_memory_pool/read_index.o shared_memory_pool/block_run_cache.o shared_memory_pool/numa_topology.o persistence/persistence.o
 if errorlevel 1 (
   echo Failed to create static library
   pause
@@ -85,6 +163,19 @@ echo.
 echo Cleaning up...
 del api\smm_api.o 2>nul
 del shared_memory_pool\shared_memory_pool.o 2>nul
+del shared_memory_pool\free_space_bitmap.o 2>nul
+del shared_memory_pool\free_extent_index.o 2>nul
+del shared_memory_pool\tlsf_index.o 2>nul
+del shared_memory_pool\slab_allocator.o 2>nul
+del shared_memory_pool\page_memory.o 2>nul
+del shared_memory_pool\shared_segment.o 2>nul
+del shared_memory_pool\background_compactor.o 2>nul
+del shared_memory_pool\memory_id_index.o 2>nul
+del shared_memory_pool\arena_pool.o 2>nul
+del shared_memory_pool\epoch_reclaimer.o 2>nul
+del shared_memory_pool\read_index.o 2>nul
+del shared_memory_pool\block_run_cache.o 2>nul
+del shared_memory_pool\numa_topology.o 2>nul
 del persistence\persistence.o 2>nul
 
 echo.
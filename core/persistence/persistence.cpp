@@ -2,19 +2,76 @@
 #include <fstream>
 #include <cstring>
 #include <vector>
+#include <algorithm>
 
 namespace Persistence {
 static constexpr uint32_t kFileMagic = 0x4D454D50; // "MEMP"
+// 文件格式版本
+// 0：旧格式（每块一条元数据 + 使用状态位图 + memory_info + 最后修改时间 + 内存池数据）
+// 1：按分配记录保存（每次分配一条记录，块归属和位图在加载时重建）
+static constexpr uint32_t kFormatLegacy = 0;
+static constexpr uint32_t kFormatRecords = 1;
 
 // 文件头结构
 struct FileHeader {
     uint32_t magic;            // 文件魔数
-    uint32_t reserved_version; // 保留字段（不再使用）
+    uint32_t version;          // 文件格式版本（旧版本文件为 0）
     size_t free_block_count;   // 空闲块数量
-    size_t memory_info_count;  // memory_info 的数量
-    uint64_t reserved[4];      // 预留字段
+    size_t memory_info_count;  // 分配记录数量
+    uint64_t pool_size;        // 内存池大小（旧版本文件为 0，表示默认 1GB）
+    uint64_t block_size;       // 块大小（旧版本文件为 0，表示默认 4KB）
+    uint64_t reserved[2];      // 预留字段
 };
 
+// 写入/读取长度前缀的字符串
+static void WriteString(std::ofstream& file, const std::string& str) {
+    size_t len = str.size();
+    file.write(reinterpret_cast<const char*>(&len), sizeof(size_t));
+    if (len > 0) {
+        file.write(str.data(), len);
+    }
+}
+
+static bool ReadString(std::ifstream& file, std::string& str) {
+    size_t len = 0;
+    if (!file.read(reinterpret_cast<char*>(&len), sizeof(size_t))) {
+        return false;
+    }
+    str.assign(len, '\0');
+    if (len > 0) {
+        file.read(&str[0], len);
+    }
+    return file.good();
+}
+
+// 计算内容长度（旧格式没有记录字节数，按遇到 0 为止计算）
+static size_t ContentLength(const uint8_t* data, size_t maxSize) {
+    const void* end = std::memchr(data, 0, maxSize);
+    return end ? static_cast<size_t>(static_cast<const uint8_t*>(end) - data) : maxSize;
+}
+
+// 读取内存池数据（内存池刚重置为零页，只写入已使用的块，空闲块不占用物理内存）
+template <typename IsUsed>
+static bool ReadPoolData(std::ifstream& file, SharedMemoryPool& smp, IsUsed isUsed) {
+    const size_t blockSize = smp.GetBlockSize();
+    const size_t poolSize = smp.GetPoolSize();
+    const size_t chunkSize = std::max<size_t>(64 * 1024, blockSize); // 块大小的整数倍
+    uint8_t* poolData = smp.GetPoolData();
+    std::vector<uint8_t> chunk(chunkSize);
+    for (size_t offset = 0; offset < poolSize; offset += chunkSize) {
+        size_t size = std::min(chunkSize, poolSize - offset);
+        if (!file.read(reinterpret_cast<char*>(chunk.data()), size)) {
+            return false;
+        }
+        for (size_t pos = 0; pos < size; pos += blockSize) {
+            if (isUsed((offset + pos) / blockSize)) {
+                std::memcpy(poolData + offset + pos, chunk.data() + pos, blockSize);
+            }
+        }
+    }
+    return true;
+}
+
 bool Save(const SharedMemoryPool& smp, const std::string& filename) {
     std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
@@ -23,88 +80,47 @@ bool Save(const SharedMemoryPool& smp, const std::string& filename) {
 
     try {
         // 1. 写入文件头
+        const auto records = smp.GetAllocationsByStart();
         FileHeader header{};
         header.magic = kFileMagic;
-        header.reserved_version = 0;
-
-        // 获取内部数据（需要通过公共接口）
-        const auto& memoryInfo = smp.GetMemoryInfo();
-        header.free_block_count = 0; // 需要计算，暂时设为0
-        header.memory_info_count = memoryInfo.size();
-
-        // 计算空闲块数量（通过遍历元数据）
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            const auto& meta = smp.GetMeta(i);
-            if (!meta.used) {
-                header.free_block_count++;
-            }
-        }
-
+        header.version = kFormatRecords;
+        header.free_block_count = smp.GetFreeBlockCount();
+        header.memory_info_count = records.size();
+        header.pool_size = smp.GetPoolSize();
+        header.block_size = smp.GetBlockSize();
         file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
 
-        // 2. 写入元数据数组
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            const auto& meta = smp.GetMeta(i);
-
-            bool used = meta.used;
-            file.write(reinterpret_cast<const char*>(&used), sizeof(bool));
-
-            // 写入 memory_id
-            size_t memoryIdLen = meta.memory_id.size();
-            file.write(reinterpret_cast<const char*>(&memoryIdLen), sizeof(size_t));
-            if (memoryIdLen > 0) {
-                file.write(meta.memory_id.c_str(), memoryIdLen);
-            }
-
-            // 写入 description
-            size_t descLen = meta.description.size();
-            file.write(reinterpret_cast<const char*>(&descLen), sizeof(size_t));
-            if (descLen > 0) {
-                file.write(meta.description.c_str(), descLen);
-            }
-        }
-
-        // 3. 写入 used_map (需要访问内部数据，暂时跳过，通过元数据重建)
-        // 或者我们需要在 SharedMemoryPool 中添加访问 used_map 的接口
-        // 这里先写入一个占位符，实际使用时需要添加接口
-        std::vector<uint8_t> bitsetBytes((SharedMemoryPool::kBlockCount + 7) / 8, 0);
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            const auto& meta = smp.GetMeta(i);
-            if (meta.used) {
-                bitsetBytes[i / 8] |= (1 << (i % 8));
-            }
-        }
-        file.write(reinterpret_cast<const char*>(bitsetBytes.data()), bitsetBytes.size());
-
-        // 4. 写入 memory_info
-        for (const auto& entry : memoryInfo) {
-            size_t keyLen = entry.first.size();
-            file.write(reinterpret_cast<const char*>(&keyLen), sizeof(size_t));
-            file.write(entry.first.c_str(), keyLen);
-
-            file.write(reinterpret_cast<const char*>(&entry.second.first), sizeof(size_t));
-            file.write(reinterpret_cast<const char*>(&entry.second.second), sizeof(size_t));
+        // 2. 写入分配记录
+        for (const auto* record : records) {
+            WriteString(file, record->memory_id);
+            WriteString(file, record->description);
+            file.write(reinterpret_cast<const char*>(&record->start_block), sizeof(size_t));
+            file.write(reinterpret_cast<const char*>(&record->block_count), sizeof(size_t));
+            file.write(reinterpret_cast<const char*>(&record->byte_length), sizeof(size_t));
+            file.write(reinterpret_cast<const char*>(&record->last_modified), sizeof(time_t));
+            file.write(reinterpret_cast<const char*>(&record->slab_slot), sizeof(int32_t));
         }
 
-        // 5. 写入 memory_last_modified_time
-        const auto& timeMap = smp.GetMemoryLastModifiedTimeMap();
-        size_t timeMapCount = timeMap.size();
-        file.write(reinterpret_cast<const char*>(&timeMapCount), sizeof(size_t));
-        for (const auto& entry : timeMap) {
-            size_t keyLen = entry.first.size();
-            file.write(reinterpret_cast<const char*>(&keyLen), sizeof(size_t));
-            file.write(entry.first.c_str(), keyLen);
-            time_t timeValue = entry.second;
-            file.write(reinterpret_cast<const char*>(&timeValue), sizeof(time_t));
+        // 3. 写入 slab 信息
+        const auto& slabs = smp.GetSlabAllocator().GetSlabs();
+        size_t slabCount = slabs.size();
+        file.write(reinterpret_cast<const char*>(&slabCount), sizeof(size_t));
+        for (const auto& entry : slabs) {
+            size_t block = entry.first;
+            uint32_t sizeClass = entry.second.size_class;
+            uint64_t usedMask = entry.second.used_mask;
+            file.write(reinterpret_cast<const char*>(&block), sizeof(size_t));
+            file.write(reinterpret_cast<const char*>(&sizeClass), sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(&usedMask), sizeof(uint64_t));
         }
 
-        // 6. 写入 next_search_pos_（Next Fit 优化位置）
+        // 4. 写入 next_search_pos_（Next Fit 优化位置）
         size_t nextSearchPos = smp.GetNextSearchPos();
         file.write(reinterpret_cast<const char*>(&nextSearchPos), sizeof(size_t));
 
-        // 7. 写入内存池数据
+        // 5. 写入内存池数据
         const uint8_t* poolData = smp.GetPoolData();
-        file.write(reinterpret_cast<const char*>(poolData), SharedMemoryPool::kPoolSize);
+        file.write(reinterpret_cast<const char*>(poolData), smp.GetPoolSize());
 
         return file.good();
     } catch (...) {
@@ -112,139 +128,220 @@ bool Save(const SharedMemoryPool& smp, const std::string& filename) {
     }
 }
 
-bool Load(SharedMemoryPool& smp, const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        return false;
+// 读取当前格式（分配记录）
+static bool LoadRecords(std::ifstream& file, SharedMemoryPool& smp, const FileHeader& header) {
+    // 1. 读取分配记录
+    std::vector<SharedMemoryPool::AllocationRecord> records(header.memory_info_count);
+    for (auto& record : records) {
+        if (!ReadString(file, record.memory_id) || !ReadString(file, record.description)) {
+            return false;
+        }
+        file.read(reinterpret_cast<char*>(&record.start_block), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&record.block_count), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&record.byte_length), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&record.last_modified), sizeof(time_t));
+        file.read(reinterpret_cast<char*>(&record.slab_slot), sizeof(int32_t));
     }
 
-    try {
-        // 1. 读取文件头
-        FileHeader header{};
-        file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+    // 2. 读取并恢复 slab
+    size_t slabCount = 0;
+    file.read(reinterpret_cast<char*>(&slabCount), sizeof(size_t));
+    for (size_t i = 0; i < slabCount && file.good(); ++i) {
+        size_t block;
+        uint32_t sizeClass;
+        uint64_t usedMask;
+        file.read(reinterpret_cast<char*>(&block), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&sizeClass), sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(&usedMask), sizeof(uint64_t));
+        if (!smp.RestoreSlab(block, static_cast<int>(sizeClass), usedMask)) {
+            return false;
+        }
+    }
 
-        if (header.magic != kFileMagic) {
+    // 3. 恢复分配记录（同步重建块归属、位图和空闲索引）
+    for (const auto& record : records) {
+        if (!smp.RestoreAllocation(record)) {
             return false;
         }
+    }
 
-        // 2. 重置内存池
-        smp.Reset();
+    // 4. 读取 next_search_pos_
+    size_t nextSearchPos = 0;
+    file.read(reinterpret_cast<char*>(&nextSearchPos), sizeof(size_t));
+    smp.SetNextSearchPos(nextSearchPos);
 
-        // 3. 读取元数据
-        struct MetaData {
-            bool used;
-            std::string memory_id;
-            std::string description;
-        };
-        std::vector<MetaData> metaData(SharedMemoryPool::kBlockCount);
-
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            file.read(reinterpret_cast<char*>(&metaData[i].used), sizeof(bool));
-
-            // 读取 memory_id
-            size_t memoryIdLen;
-            file.read(reinterpret_cast<char*>(&memoryIdLen), sizeof(size_t));
-            metaData[i].memory_id.resize(memoryIdLen);
-            if (memoryIdLen > 0) {
-                file.read(&metaData[i].memory_id[0], memoryIdLen);
-            }
+    // 5. 读取内存池数据
+    const auto& usedMap = smp.GetUsedMap();
+    return ReadPoolData(file, smp, [&usedMap](size_t block) { return usedMap[block]; });
+}
 
-            // 读取 description
-            size_t descLen;
-            file.read(reinterpret_cast<char*>(&descLen), sizeof(size_t));
-            metaData[i].description.resize(descLen);
-            if (descLen > 0) {
-                file.read(&metaData[i].description[0], descLen);
-            }
+// 读取旧格式（每块一条元数据），转换为分配记录
+static bool LoadLegacy(std::ifstream& file, SharedMemoryPool& smp, const FileHeader& header) {
+    const size_t blockCount = smp.GetBlockCount();
+    const size_t blockSize = smp.GetBlockSize();
+
+    // 1. 读取元数据（只保留描述和使用状态，memory_id 可以从 memory_info 得到）
+    std::vector<std::string> descriptions(blockCount);
+    std::vector<bool> usedBlocks(blockCount);
+    std::string memoryId;
+    for (size_t i = 0; i < blockCount; ++i) {
+        bool used = false;
+        file.read(reinterpret_cast<char*>(&used), sizeof(bool));
+        usedBlocks[i] = used;
+        if (!ReadString(file, memoryId) || !ReadString(file, descriptions[i])) {
+            return false;
         }
+    }
 
-        // 4. 读取并设置 used_map
-        std::vector<uint8_t> bitsetBytes((SharedMemoryPool::kBlockCount + 7) / 8, 0);
-        file.read(reinterpret_cast<char*>(bitsetBytes.data()), bitsetBytes.size());
-        // 从字节数组恢复 bitset
-        auto& usedMap = smp.GetUsedMap();
-        usedMap.reset(); // 先全部清零
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            if (bitsetBytes[i / 8] & (1 << (i % 8))) {
-                usedMap.set(i, true);
-            }
+    // 2. 跳过使用状态位图（由分配记录重建）
+    file.seekg(static_cast<std::streamoff>((blockCount + 7) / 8), std::ios::cur);
+
+    // 3. 读取 memory_info
+    std::vector<SharedMemoryPool::AllocationRecord> records(header.memory_info_count);
+    for (auto& record : records) {
+        if (!ReadString(file, record.memory_id)) {
+            return false;
+        }
+        file.read(reinterpret_cast<char*>(&record.start_block), sizeof(size_t));
+        file.read(reinterpret_cast<char*>(&record.block_count), sizeof(size_t));
+        if (record.start_block < blockCount) {
+            record.description = descriptions[record.start_block];
+        }
+    }
+    descriptions.clear();
+
+    // 4. 读取 memory_last_modified_time
+    size_t timeMapCount = 0;
+    file.read(reinterpret_cast<char*>(&timeMapCount), sizeof(size_t));
+    std::map<std::string, time_t> timeMap;
+    for (size_t i = 0; i < timeMapCount; ++i) {
+        std::string key;
+        if (!ReadString(file, key)) {
+            return false;
         }
+        time_t timeValue;
+        file.read(reinterpret_cast<char*>(&timeValue), sizeof(time_t));
+        timeMap[key] = timeValue;
+    }
 
-        // 5. 设置 free_block_count
-        smp.SetFreeBlockCount(header.free_block_count);
+    // 5. 读取 next_search_pos_
+    size_t nextSearchPos = 0;
+    file.read(reinterpret_cast<char*>(&nextSearchPos), sizeof(size_t));
 
-        // 6. 设置元数据（在 used_map 设置之后）
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            if (metaData[i].used) {
-                smp.SetMetaForLoad(i, metaData[i].memory_id, metaData[i].description);
+    // 6. 读取内存池数据
+    uint8_t* poolData = smp.GetPoolData();
+    if (!ReadPoolData(file, smp, [&usedBlocks](size_t block) { return usedBlocks[block]; })) {
+        return false;
+    }
+
+    // 7. 读取 slab 小对象信息（更早的文件没有这一段，视为没有 slab）
+    size_t slabCount = 0;
+    std::map<std::string, std::pair<size_t, std::string>> slabObjects; // 槽位, 描述
+    if (file.read(reinterpret_cast<char*>(&slabCount), sizeof(size_t))) {
+        for (size_t i = 0; i < slabCount; ++i) {
+            size_t block;
+            uint32_t sizeClass;
+            uint64_t usedMask;
+            file.read(reinterpret_cast<char*>(&block), sizeof(size_t));
+            file.read(reinterpret_cast<char*>(&sizeClass), sizeof(uint32_t));
+            file.read(reinterpret_cast<char*>(&usedMask), sizeof(uint64_t));
+            if (!file.good() || !smp.RestoreSlab(block, static_cast<int>(sizeClass), usedMask)) {
+                return false;
             }
         }
-
-        // 7. 读取并设置 memory_info
-        size_t infoCount = header.memory_info_count;
-        std::map<std::string, std::pair<size_t, size_t>> memoryInfo;
-        for (size_t i = 0; i < infoCount; ++i) {
-            size_t keyLen;
-            file.read(reinterpret_cast<char*>(&keyLen), sizeof(size_t));
-            std::string key(keyLen, '\0');
-            if (keyLen > 0) {
-                file.read(&key[0], keyLen);
+        size_t objectCount = 0;
+        file.read(reinterpret_cast<char*>(&objectCount), sizeof(size_t));
+        for (size_t i = 0; i < objectCount; ++i) {
+            std::string key;
+            size_t slot;
+            std::string description;
+            if (!ReadString(file, key)) {
+                return false;
             }
-
-            size_t startBlock;
-            size_t blockCount;
-            file.read(reinterpret_cast<char*>(&startBlock), sizeof(size_t));
-            file.read(reinterpret_cast<char*>(&blockCount), sizeof(size_t));
-
-            memoryInfo[key] = std::make_pair(startBlock, blockCount);
-        }
-        smp.SetMemoryInfo(memoryInfo);
-
-        // 8. 读取 memory_last_modified_time
-        size_t timeMapCount;
-        file.read(reinterpret_cast<char*>(&timeMapCount), sizeof(size_t));
-        std::map<std::string, time_t> timeMap;
-        for (size_t i = 0; i < timeMapCount; ++i) {
-            size_t keyLen;
-            file.read(reinterpret_cast<char*>(&keyLen), sizeof(size_t));
-            std::string key(keyLen, '\0');
-            if (keyLen > 0) {
-                file.read(&key[0], keyLen);
+            file.read(reinterpret_cast<char*>(&slot), sizeof(size_t));
+            if (!ReadString(file, description)) {
+                return false;
             }
-            time_t timeValue;
-            file.read(reinterpret_cast<char*>(&timeValue), sizeof(time_t));
-            timeMap[key] = timeValue;
+            slabObjects[key] = std::make_pair(slot, description);
         }
-        smp.SetMemoryLastModifiedTimeMap(timeMap);
+    }
 
-        // 9. 读取 next_search_pos_
-        size_t nextSearchPos;
-        file.read(reinterpret_cast<char*>(&nextSearchPos), sizeof(size_t));
-        if (file.good()) {
-            smp.SetNextSearchPos(nextSearchPos);
-        } else {
-            // 如果读取失败，计算第一个空闲位置
-            size_t firstFreePos = 0;
-            for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-                const auto& meta = smp.GetMeta(i);
-                if (!meta.used) {
-                    firstFreePos = i;
-                    break;
-                }
+    // 8. 转换为分配记录
+    const auto& slabAllocator = smp.GetSlabAllocator();
+    for (auto& record : records) {
+        auto timeIt = timeMap.find(record.memory_id);
+        record.last_modified = (timeIt != timeMap.end()) ? timeIt->second : 0;
+
+        auto slabIt = slabObjects.find(record.memory_id);
+        if (slabIt != slabObjects.end()) {
+            record.slab_slot = static_cast<int32_t>(slabIt->second.first);
+            record.description = slabIt->second.second;
+            int sizeClass = slabAllocator.GetSizeClass(record.start_block);
+            if (sizeClass < 0) {
+                return false;
             }
-            smp.SetNextSearchPos(firstFreePos);
+            size_t slotSize = slabAllocator.SlotSize(sizeClass);
+            size_t offset = record.start_block * blockSize + slabIt->second.first * slotSize;
+            record.byte_length = ContentLength(poolData + offset, slotSize);
+        } else if (record.start_block + record.block_count <= blockCount) {
+            record.byte_length = ContentLength(poolData + record.start_block * blockSize,
+                                               record.block_count * blockSize);
+        }
+        if (!smp.RestoreAllocation(record)) {
+            return false;
         }
+    }
+    smp.SetNextSearchPos(nextSearchPos);
+    return true;
+}
 
-        // 10. 读取内存池数据
-        uint8_t* poolData = smp.GetPoolData();
-        file.read(reinterpret_cast<char*>(poolData), SharedMemoryPool::kPoolSize);
+bool Load(SharedMemoryPool& smp, const std::string& filename) {
+    // 加载会重置或重新映射内存池，仍有调用方持有内存池中的地址时不能加载
+    if (smp.HasExternalReferences()) {
+        return false;
+    }
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    try {
+        // 1. 读取文件头
+        FileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
 
-        // 11. 初始化 Memory ID 计数器（确保计数器大于所有已存在的 ID）
-        if (file.good()) {
-            smp.InitializeMemoryIdCounter();
+        if (!file.good() || header.magic != kFileMagic) {
+            return false;
+        }
+        if (header.version != kFormatLegacy && header.version != kFormatRecords) {
+            return false;
         }
 
-        return file.good();
+        // 2. 按文件中的规格重新初始化内存池（规格不同时），否则直接重置
+        //    共享段的规格由创建者决定，规格不同时不能加载
+        size_t poolSize = header.pool_size ? static_cast<size_t>(header.pool_size)
+                                           : SharedMemoryPool::kDefaultPoolSize;
+        size_t blockSize = header.block_size ? static_cast<size_t>(header.block_size)
+                                             : SharedMemoryPool::kDefaultBlockSize;
+        if (poolSize != smp.GetPoolSize() || blockSize != smp.GetBlockSize()) {
+            if (smp.IsShared() || !smp.Init(poolSize, blockSize, smp.GetAllocationPolicy())) {
+                return false;
+            }
+        } else {
+            smp.Reset();
+        }
+
+        // 3. 按文件格式读取（失败时清空，避免留下不完整的状态）
+        bool loaded = (header.version == kFormatRecords) ? LoadRecords(file, smp, header)
+                                                         : LoadLegacy(file, smp, header);
+        if (!loaded) {
+            smp.Reset();
+            return false;
+        }
+
+        // 4. 初始化 Memory ID 计数器（确保计数器大于所有已存在的 ID）
+        smp.InitializeMemoryIdCounter();
+        return true;
     } catch (...) {
         return false;
     }
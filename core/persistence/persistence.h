@@ -7,7 +7,7 @@ namespace Persistence {
 // 保存内存池到文件
 bool Save(const SharedMemoryPool& smp, const std::string& filename = "memory_pool.dat");
 
-// 从文件加载内存池
+// 从文件加载内存池（文件中的内存池规格与当前不同时，按文件规格重新初始化）
 bool Load(SharedMemoryPool& smp, const std::string& filename = "memory_pool.dat");
 
 // 默认文件名
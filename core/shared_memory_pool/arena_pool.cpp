@@ -0,0 +1,195 @@
+#include "arena_pool.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace {
+thread_local size_t t_thread_arena = ArenaPool::npos; // SetThreadArena 绑定的 arena
+// 查询只加 arena 的读锁
+constexpr auto kReadLock = SharedMemoryPool::SharedLock::Mode::kRead;
+} // namespace
+
+bool ArenaPool::Init(const Settings& settings) {
+    size_t count = settings.arena_count;
+    if (count == 0) {
+        count = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    }
+    count = std::min(count, kMaxArenaCount);
+    size_t total = count + (settings.large_arena_size > 0 ? 1 : 0);
+    size_t nodes = settings.numa_aware ? NumaTopology::NodeCount() : 1;
+
+    std::vector<std::unique_ptr<SharedMemoryPool>> arenas;
+    std::vector<std::vector<size_t>> nodeArenas(nodes > 1 ? nodes : 0);
+    for (size_t i = 0; i < total; ++i) {
+        size_t size = (i < count) ? settings.arena_size : settings.large_arena_size;
+        auto arena = std::make_unique<SharedMemoryPool>();
+        // 普通 arena 轮流放到各节点，大分配 arena 轮流分布到所有节点
+        if (nodes > 1) {
+            arena->SetNumaNode((i < count) ? static_cast<int>(i % nodes)
+                                           : NumaTopology::kInterleave);
+            if (i < count) {
+                nodeArenas[i % nodes].push_back(i);
+            }
+        }
+        if (!arena->Init(size, settings.block_size, settings.policy)) {
+            return false;
+        }
+        // 编号 i + 1, i + 1 + total, ... 属于 arena i
+        arena->SetMemoryIdSequence(i + 1, total);
+        arena->EnableLockFreeReads(); // Read 不加 arena 的锁
+        arenas.push_back(std::move(arena));
+    }
+    arenas_ = std::move(arenas);
+    node_arenas_ = std::move(nodeArenas);
+    normal_count_ = count;
+    large_threshold_ = settings.large_threshold;
+    return true;
+}
+
+size_t ArenaPool::GetThreadArena() const {
+    if (t_thread_arena != npos) {
+        return t_thread_arena % normal_count_;
+    }
+    size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+    if (!node_arenas_.empty()) {
+        const std::vector<size_t>& local = node_arenas_[NumaTopology::CurrentNode() %
+                                                        node_arenas_.size()];
+        if (!local.empty()) {
+            return local[hash % local.size()];
+        }
+    }
+    return hash % normal_count_;
+}
+
+void ArenaPool::SetThreadArena(size_t index) {
+    t_thread_arena = index;
+}
+
+std::string ArenaPool::AllocateIn(size_t index, const std::string& description, const void* data,
+                                  size_t dataSize) {
+    SharedMemoryPool& arena = *arenas_[index];
+    SharedMemoryPool::SharedLock lock(arena);
+    std::string memory_id = arena.GenerateNextMemoryId();
+    if (arena.AllocateBlock(memory_id, description, data, dataSize) < 0) {
+        return "";
+    }
+    return memory_id;
+}
+
+std::string ArenaPool::Allocate(const std::string& description, const void* data,
+                                size_t dataSize) {
+    if (arenas_.empty()) {
+        return "";
+    }
+    // 大分配先尝试大分配 arena，普通 arena 都放不下时最后再尝试它
+    bool large = HasLargeArena() && dataSize >= large_threshold_;
+    if (large) {
+        std::string memory_id = AllocateIn(normal_count_, description, data, dataSize);
+        if (!memory_id.empty()) {
+            return memory_id;
+        }
+    }
+    // 第一遍只尝试与当前 arena 同一节点的 arena，第二遍尝试其他节点（单节点时第一遍即全部）
+    size_t home = GetThreadArena();
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < normal_count_; ++i) {
+            size_t index = (home + i) % normal_count_;
+            bool local = (GetArenaNode(index) == GetArenaNode(home));
+            if (local != (pass == 0)) {
+                continue;
+            }
+            std::string memory_id = AllocateIn(index, description, data, dataSize);
+            if (!memory_id.empty()) {
+                return memory_id;
+            }
+        }
+    }
+    if (HasLargeArena() && !large) {
+        return AllocateIn(normal_count_, description, data, dataSize);
+    }
+    return "";
+}
+
+size_t ArenaPool::ArenaFor(const std::string& memory_id) {
+    uint64_t number = 0;
+    if (MemoryIdIndex::ParseId(memory_id, number)) {
+        return (number > 0 && !arenas_.empty())
+                   ? static_cast<size_t>((number - 1) % arenas_.size())
+                   : npos;
+    }
+    for (size_t i = 0; i < arenas_.size(); ++i) {
+        SharedMemoryPool::SharedLock lock(*arenas_[i], kReadLock);
+        if (arenas_[i]->FindMemory(memory_id)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+size_t ArenaPool::FindArena(const std::string& memory_id) {
+    size_t index = ArenaFor(memory_id);
+    if (index == npos) {
+        return npos;
+    }
+    SharedMemoryPool::SharedLock lock(*arenas_[index], kReadLock);
+    return arenas_[index]->FindMemory(memory_id) ? index : npos;
+}
+
+bool ArenaPool::Free(const std::string& memory_id) {
+    size_t index = ArenaFor(memory_id);
+    if (index == npos) {
+        return false;
+    }
+    SharedMemoryPool::SharedLock lock(*arenas_[index]);
+    return arenas_[index]->FreeByMemoryId(memory_id);
+}
+
+bool ArenaPool::Update(const std::string& memory_id, const void* data, size_t dataSize) {
+    size_t index = ArenaFor(memory_id);
+    if (index == npos) {
+        return false;
+    }
+    SharedMemoryPool::SharedLock lock(*arenas_[index]);
+    return arenas_[index]->Update(memory_id, data, dataSize) >= 0;
+}
+
+bool ArenaPool::Read(const std::string& memory_id, std::string& content) {
+    size_t index = ArenaFor(memory_id);
+    if (index == npos) {
+        return false;
+    }
+    SharedMemoryPool::MemorySnapshot snapshot;
+    if (!arenas_[index]->ReadMemorySnapshot(memory_id, snapshot)) {
+        return false;
+    }
+    content.swap(snapshot.content);
+    return true;
+}
+
+ArenaPool::Status ArenaPool::GetStatus() {
+    Status status;
+    for (auto& arena : arenas_) {
+        SharedMemoryPool::SharedLock lock(*arena, kReadLock);
+        status.pool_size += arena->GetPoolSize();
+        status.total_blocks += arena->GetBlockCount();
+        status.free_blocks += arena->GetFreeBlockCount();
+        status.allocated_count += arena->GetAllocationCount();
+        status.resident_bytes += arena->GetResidentBytes();
+        SharedMemoryPool::FragmentationStats frag = arena->GetFragmentationStats();
+        status.fragmentation.free_blocks += frag.free_blocks;
+        status.fragmentation.fragment_count += frag.fragment_count;
+        status.fragmentation.largest_free_run =
+            std::max(status.fragmentation.largest_free_run, frag.largest_free_run);
+        for (size_t i = 0; i < frag.run_histogram.size(); ++i) {
+            status.fragmentation.run_histogram[i] += frag.run_histogram[i];
+        }
+        std::vector<size_t> nodeBytes = arena->GetResidentBytesByNode();
+        if (nodeBytes.size() > status.node_resident_bytes.size()) {
+            status.node_resident_bytes.resize(nodeBytes.size(), 0);
+        }
+        for (size_t i = 0; i < nodeBytes.size(); ++i) {
+            status.node_resident_bytes[i] += nodeBytes[i];
+        }
+    }
+    return status;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "shared_memory_pool.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 多 arena 内存池
+// 把内存池分成多个相互独立的 arena（各自有内存区域、空闲位图/索引和操作锁），
+// 线程默认按线程 ID 哈希到一个 arena，不同 arena 上的分配/释放可以并行执行；
+// 不小于 large_threshold 的大分配优先放入专用的大分配 arena，不占用普通 arena 的连续空间。
+// Memory ID 的编号按 arena 交错生成（编号 n 属于 arena (n - 1) % arena 总数），
+// 查找 ID 所属的 arena 不需要全局索引和全局锁。
+// 多 NUMA 节点时普通 arena 轮流分配到各节点（页面优先落在所属节点），线程优先使用当前所在节点的
+// arena，大分配 arena 的页面轮流分布到所有节点；单节点时与不区分节点相同
+class ArenaPool {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t kMaxArenaCount = 256;                   // 普通 arena 数量上限
+    static constexpr size_t kDefaultArenaSize = 64 * 1024 * 1024;    // 默认每个 arena 64MB
+    static constexpr size_t kDefaultLargeThreshold = 1024 * 1024;    // 默认大分配阈值 1MB
+
+    struct Settings {
+        size_t arena_count = 0;                // 普通 arena 数量（0 表示按 CPU 核数）
+        size_t arena_size = kDefaultArenaSize; // 每个普通 arena 的大小
+        size_t block_size = SharedMemoryPool::kDefaultBlockSize;
+        size_t large_arena_size = 0; // 大分配 arena 的大小（0 表示不设置，大分配按普通分配处理）
+        size_t large_threshold = kDefaultLargeThreshold; // 大分配阈值（字节）
+        SharedMemoryPool::AllocationPolicy policy = SharedMemoryPool::AllocationPolicy::kBestFit;
+        bool numa_aware = true; // 按 NUMA 节点放置 arena（false 时由首次写入的线程决定）
+    };
+
+    // 汇总状态（逐个 arena 加锁读取）
+    struct Status {
+        size_t pool_size = 0;       // 所有 arena 的总大小（字节）
+        size_t total_blocks = 0;    // 总块数
+        size_t free_blocks = 0;     // 空闲块数
+        size_t allocated_count = 0; // 分配数量
+        size_t resident_bytes = 0;  // 常驻物理内存（字节）
+        SharedMemoryPool::FragmentationStats fragmentation; // 各 arena 合计（最大空闲区间取最大值）
+        std::vector<size_t> node_resident_bytes; // 常驻物理内存按 NUMA 节点的分布
+    };
+
+    ArenaPool() = default;
+    ArenaPool(const ArenaPool&) = delete;
+    ArenaPool& operator=(const ArenaPool&) = delete;
+
+    bool Init(const Settings& settings);
+    // arena 总数（含大分配 arena，大分配 arena 位于最后）
+    size_t GetArenaCount() const {
+        return arenas_.size();
+    }
+    size_t GetNormalArenaCount() const {
+        return normal_count_;
+    }
+    bool HasLargeArena() const {
+        return arenas_.size() > normal_count_;
+    }
+    SharedMemoryPool& GetArena(size_t index) {
+        return *arenas_[index];
+    }
+    // arena 所在的 NUMA 节点（NumaTopology::kInterleave 表示轮流分布，单节点时为 kAnyNode）
+    int GetArenaNode(size_t index) const {
+        return arenas_[index]->GetNumaNode();
+    }
+
+    // 当前线程使用的普通 arena：SetThreadArena 绑定过的 arena，否则在当前所在节点的 arena 中
+    // 按线程 ID 哈希（线程可能被调度到其他节点，需要固定时先调用 NumaTopology::PinThreadToNode）
+    size_t GetThreadArena() const;
+    // 把当前线程绑定到 arena（例如每个连接线程绑定一个 arena），npos 表示恢复按线程 ID 哈希
+    static void SetThreadArena(size_t index);
+
+    // 分配：先尝试当前线程的 arena（大分配先尝试大分配 arena），空间不足时依次尝试
+    // 同一节点上的其他 arena、其他节点上的 arena
+    // 成功返回 Memory ID，失败返回空串
+    std::string Allocate(const std::string& description, const void* data, size_t dataSize);
+    bool Free(const std::string& memory_id);
+    // 在 ID 所属的 arena 内更新（原地覆盖/扩展或在 arena 内搬迁，不跨 arena，ID 保持不变）
+    bool Update(const std::string& memory_id, const void* data, size_t dataSize);
+    bool Read(const std::string& memory_id, std::string& content);
+    // Memory ID 所属的 arena（不存在返回 npos）
+    size_t FindArena(const std::string& memory_id);
+    Status GetStatus();
+
+  private:
+    std::string AllocateIn(size_t index, const std::string& description, const void* data,
+                           size_t dataSize);
+    // 标准格式的 ID 直接按编号确定 arena（不检查是否存在），其他格式的 ID 逐个 arena 查找
+    size_t ArenaFor(const std::string& memory_id);
+
+    size_t normal_count_ = 0;
+    size_t large_threshold_ = 0;
+    std::vector<std::vector<size_t>> node_arenas_; // 节点 -> 该节点上的普通 arena（单节点时为空）
+    std::vector<std::unique_ptr<SharedMemoryPool>> arenas_;
+};
@@ -0,0 +1,82 @@
+#include "background_compactor.h"
+#include "shared_memory_pool.h"
+
+void BackgroundCompactor::Start(const Settings& settings) {
+    Stop();
+    settings_ = settings;
+    stop_ = false;
+    thread_ = std::thread(&BackgroundCompactor::Run, this);
+}
+
+void BackgroundCompactor::Stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_all();
+    thread_.join();
+    active_ = false;
+}
+
+BackgroundCompactor::Stats BackgroundCompactor::GetStats() const {
+    Stats stats;
+    stats.steps = steps_.load();
+    stats.passes = passes_.load();
+    stats.active = active_.load();
+    return stats;
+}
+
+double BackgroundCompactor::GetFragmentation(const SharedMemoryPool& pool) {
+    // 区间缓存中的块不在空闲区间中，不参与计算
+    size_t freeBlocks = pool.GetFreeBlockCount() - pool.GetCachedBlockCount();
+    if (freeBlocks == 0) {
+        return 0.0;
+    }
+    size_t maxRun = pool.GetMaxContinuousFreeBlocks();
+    return 1.0 - static_cast<double>(maxRun) / static_cast<double>(freeBlocks);
+}
+
+bool BackgroundCompactor::WaitFor(std::chrono::microseconds duration) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !wakeup_.wait_for(lock, duration, [this]() { return stop_; });
+}
+
+void BackgroundCompactor::Run() {
+    while (WaitFor(settings_.check_interval)) {
+        // 空闲时只检查碎片率，超过高水位才开始紧凑
+        {
+            SharedMemoryPool::SharedLock lock(pool_, SharedMemoryPool::SharedLock::Mode::kRead);
+            if (GetFragmentation(pool_) < settings_.high_watermark) {
+                continue;
+            }
+        }
+
+        // 分步紧凑，每一步之后让出锁，直到本轮完成或碎片率降到低水位
+        active_ = true;
+        bool running = true;
+        while (running) {
+            bool finished = false;
+            double fragmentation = 0.0;
+            {
+                SharedMemoryPool::SharedLock lock(pool_);
+                finished = pool_.CompactFor(settings_.step_budget);
+                fragmentation = GetFragmentation(pool_);
+            }
+            steps_++;
+            if (finished) {
+                passes_++;
+            }
+            if (finished || fragmentation <= settings_.low_watermark) {
+                break;
+            }
+            running = WaitFor(settings_.step_pause);
+        }
+        active_ = false;
+        if (!running) {
+            break;
+        }
+    }
+}
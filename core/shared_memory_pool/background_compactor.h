@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+class SharedMemoryPool;
+
+// 后台紧凑线程
+// 定期检查碎片率（1 - 最大连续空闲块 / 总空闲块），超过高水位时开始增量紧凑，
+// 每一步在内存池锁（SharedMemoryPool::SharedLock）内最多执行 step_budget，
+// 步与步之间释放锁并暂停 step_pause，让前台请求优先执行；降到低水位或本轮完成后停止
+class BackgroundCompactor {
+  public:
+    struct Settings {
+        double high_watermark = 0.5; // 碎片率达到该值时开始紧凑
+        double low_watermark = 0.1;  // 碎片率降到该值以下时停止紧凑
+        std::chrono::milliseconds check_interval{100}; // 空闲时检查碎片率的间隔
+        std::chrono::microseconds step_budget{200};    // 每一步持有锁的时间预算
+        std::chrono::microseconds step_pause{1000};    // 两步之间让出锁的时间
+    };
+
+    struct Stats {
+        uint64_t steps = 0;  // 已执行的紧凑步数
+        uint64_t passes = 0; // 已完成的紧凑轮数
+        bool active = false; // 当前是否正在紧凑
+    };
+
+    explicit BackgroundCompactor(SharedMemoryPool& pool) : pool_(pool) {
+    }
+    ~BackgroundCompactor() {
+        Stop();
+    }
+    BackgroundCompactor(const BackgroundCompactor&) = delete;
+    BackgroundCompactor& operator=(const BackgroundCompactor&) = delete;
+
+    // 启动/停止后台线程（不能在持有内存池锁时调用 Stop，否则会等待后台线程而死锁）
+    void Start(const Settings& settings);
+    void Stop();
+    bool IsRunning() const {
+        return thread_.joinable();
+    }
+    const Settings& GetSettings() const {
+        return settings_;
+    }
+    Stats GetStats() const;
+
+    // 碎片率：0 表示空闲块完全连续（或没有空闲块），越接近 1 越零散（需在内存池锁内调用）
+    static double GetFragmentation(const SharedMemoryPool& pool);
+
+  private:
+    void Run();
+    // 等待 duration 或收到停止请求，返回 false 表示需要停止
+    bool WaitFor(std::chrono::microseconds duration);
+
+    SharedMemoryPool& pool_;
+    Settings settings_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stop_ = false;
+    std::atomic<uint64_t> steps_{0};
+    std::atomic<uint64_t> passes_{0};
+    std::atomic<bool> active_{false};
+};
@@ -0,0 +1,66 @@
+#include "block_run_cache.h"
+#include <algorithm>
+
+bool BlockRunCache::Push(size_t start, size_t count) {
+    if (count == 0 || count > kMaxRunBlocks || cached_blocks_ + count > kMaxCachedBlocks) {
+        return false;
+    }
+    Bin& bin = bins_[count - 1];
+    if (bin.size == kBinCapacity) {
+        return false;
+    }
+    bin.starts[bin.size++] = start;
+    cached_blocks_ += count;
+    return true;
+}
+
+bool BlockRunCache::Pop(size_t count, size_t& start) {
+    if (count == 0 || count > kMaxRunBlocks) {
+        return false;
+    }
+    Bin& bin = bins_[count - 1];
+    if (bin.size == 0) {
+        return false;
+    }
+    start = bin.starts[--bin.size];
+    bin.low_water = std::min(bin.low_water, bin.size);
+    cached_blocks_ -= count;
+    return true;
+}
+
+// 低于最低水位的区间在整个回收间隔内都没有被取用，归还它们不影响命中率
+void BlockRunCache::TakeIdle(std::vector<Run>& out) {
+    for (size_t i = 0; i < kMaxRunBlocks; ++i) {
+        TakeBottom(i + 1, bins_[i].low_water, out);
+        bins_[i].low_water = bins_[i].size;
+    }
+}
+
+void BlockRunCache::TakeAll(std::vector<Run>& out) {
+    for (size_t i = 0; i < kMaxRunBlocks; ++i) {
+        TakeBottom(i + 1, bins_[i].size, out);
+        bins_[i].low_water = 0;
+    }
+}
+
+void BlockRunCache::Clear() {
+    for (Bin& bin : bins_) {
+        bin.size = 0;
+        bin.low_water = 0;
+    }
+    cached_blocks_ = 0;
+}
+
+// 从栈底（最早放入的区间）取出 takeCount 个
+void BlockRunCache::TakeBottom(size_t runBlocks, uint32_t takeCount, std::vector<Run>& out) {
+    Bin& bin = bins_[runBlocks - 1];
+    if (takeCount == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < takeCount; ++i) {
+        out.push_back(Run{bin.starts[i], runBlocks});
+    }
+    std::copy(bin.starts + takeCount, bin.starts + bin.size, bin.starts);
+    bin.size -= takeCount;
+    cached_blocks_ -= runBlocks * takeCount;
+}
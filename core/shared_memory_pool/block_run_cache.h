@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 区间缓存：保存最近释放的短区间（1 - kMaxRunBlocks 块），再次分配相同块数时直接复用
+// 缓存属于内存池，只在内存池写锁内访问（不是无锁的线程私有缓存）
+// 缓存中的块在位图和空闲区间索引中仍标记为已使用（块归属为空闲），复用时不需要再查找和更新，
+// 归还（Flush / 空闲回收）后才重新合并进空闲区间。每个长度一个后进先出的栈，总块数有上限
+// 这里只管理区间，块的标记和统计由 SharedMemoryPool 负责
+class BlockRunCache {
+  public:
+    static constexpr size_t kMaxRunBlocks = 8;        // 缓存的区间最大块数
+    static constexpr size_t kBinCapacity = 8;         // 每个长度最多缓存的区间数
+    static constexpr size_t kMaxCachedBlocks = 64;    // 缓存的总块数上限
+    static constexpr uint32_t kCollectInterval = 256; // 每隔多少次操作回收一次闲置区间
+
+    struct Run {
+        size_t start = 0; // 起始块
+        size_t count = 0; // 块数量
+    };
+
+    // 放入区间（长度超出范围或缓存已满返回 false）
+    bool Push(size_t start, size_t count);
+    // 取出 count 块的区间（没有返回 false）
+    bool Pop(size_t count, size_t& start);
+    // 记录一次操作，到达回收间隔时返回 true（调用方随后调用 TakeIdle）
+    bool Tick() {
+        return ++ops_ % kCollectInterval == 0;
+    }
+    // 取出上次回收以来一直没有用到的区间（每个栈底部低于最低水位的部分）
+    void TakeIdle(std::vector<Run>& out);
+    // 取出所有区间
+    void TakeAll(std::vector<Run>& out);
+    // 清空（不返回区间，用于元数据重置）
+    void Clear();
+    size_t CachedBlocks() const {
+        return cached_blocks_;
+    }
+
+  private:
+    struct Bin {
+        size_t starts[kBinCapacity] = {}; // 起始块（栈，末尾为最近放入的区间）
+        uint32_t size = 0;
+        uint32_t low_water = 0; // 上次回收以来栈的最小深度
+    };
+    void TakeBottom(size_t runBlocks, uint32_t takeCount, std::vector<Run>& out);
+
+    Bin bins_[kMaxRunBlocks]; // 第 i 项缓存 i + 1 块的区间
+    size_t cached_blocks_ = 0;
+    uint32_t ops_ = 0;
+};
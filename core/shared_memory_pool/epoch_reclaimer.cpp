@@ -0,0 +1,133 @@
+#include "epoch_reclaimer.h"
+#include <algorithm>
+#include <thread>
+
+// 线程的槽位和 Guard 嵌套深度，线程退出时归还槽位
+struct EpochThreadState {
+    size_t slot = EpochReclaimer::kMaxReaders;
+    size_t depth = 0;
+    ~EpochThreadState() {
+        if (slot < EpochReclaimer::kMaxReaders) {
+            EpochReclaimer::Instance().ReleaseSlot(slot);
+        }
+    }
+};
+
+namespace {
+thread_local EpochThreadState t_epoch_state;
+} // namespace
+
+EpochReclaimer& EpochReclaimer::Instance() {
+    static EpochReclaimer instance;
+    return instance;
+}
+
+// 进程退出时不再有读者，直接释放剩余对象
+EpochReclaimer::~EpochReclaimer() {
+    for (const Retired& item : retired_) {
+        item.deleter(item.object);
+    }
+}
+
+size_t EpochReclaimer::AcquireSlot() {
+    for (size_t i = 0; i < kMaxReaders; ++i) {
+        bool expected = false;
+        if (!slots_[i].used.load(std::memory_order_relaxed) &&
+            slots_[i].used.compare_exchange_strong(expected, true)) {
+            return i;
+        }
+    }
+    return kMaxReaders;
+}
+
+void EpochReclaimer::ReleaseSlot(size_t index) {
+    slots_[index].epoch.store(0, std::memory_order_release);
+    slots_[index].used.store(false, std::memory_order_release);
+}
+
+// 登记当前 epoch 后用全序栅栏保证之后的读取不会早于登记
+// （写者摘下对象后同样经过全序栅栏再扫描槽位，看不到登记的读者也就读不到被摘下的对象）
+EpochReclaimer::Guard::Guard() {
+    EpochThreadState& state = t_epoch_state;
+    if (state.depth > 0) {
+        ++state.depth;
+        active_ = true;
+        return;
+    }
+    EpochReclaimer& reclaimer = Instance();
+    if (state.slot == kMaxReaders) {
+        state.slot = reclaimer.AcquireSlot();
+        if (state.slot == kMaxReaders) {
+            return;
+        }
+    }
+    uint64_t epoch = reclaimer.global_epoch_.load(std::memory_order_relaxed);
+    reclaimer.slots_[state.slot].epoch.store(epoch, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    state.depth = 1;
+    active_ = true;
+    outer_ = true;
+}
+
+EpochReclaimer::Guard::~Guard() {
+    if (!active_) {
+        return;
+    }
+    EpochThreadState& state = t_epoch_state;
+    --state.depth;
+    if (outer_) {
+        Instance().slots_[state.slot].epoch.store(0, std::memory_order_release);
+    }
+}
+
+void EpochReclaimer::RetireRaw(void* object, void (*deleter)(void*)) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_.push_back({global_epoch_.load(std::memory_order_relaxed), object, deleter});
+    if (retired_.size() >= kReclaimBatch) {
+        Reclaim();
+    }
+}
+
+uint64_t EpochReclaimer::MinActiveEpoch() const {
+    uint64_t minEpoch = UINT64_MAX;
+    for (const Slot& slot : slots_) {
+        uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+        if (epoch != 0) {
+            minEpoch = std::min(minEpoch, epoch);
+        }
+    }
+    return minEpoch;
+}
+
+// 推进全局 epoch 后，摘下时的 epoch 小于所有读者登记值的对象不会再被访问
+void EpochReclaimer::Reclaim() {
+    global_epoch_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t minEpoch = MinActiveEpoch();
+    auto keep = std::partition(retired_.begin(), retired_.end(),
+                               [minEpoch](const Retired& item) { return item.epoch >= minEpoch; });
+    for (auto it = keep; it != retired_.end(); ++it) {
+        it->deleter(it->object);
+    }
+    retired_.erase(keep, retired_.end());
+}
+
+void EpochReclaimer::Synchronize() {
+    uint64_t target = global_epoch_.fetch_add(1) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (const Slot& slot : slots_) {
+        for (;;) {
+            uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+            if (epoch == 0 || epoch >= target) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t EpochReclaimer::PendingCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return retired_.size();
+}
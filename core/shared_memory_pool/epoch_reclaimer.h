@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 基于 epoch 的延迟回收（进程内所有内存池共用一个实例）
+// 读者进入临界区时在自己的槽位登记当前 epoch，不加锁也不写共享的缓存行；
+// 写者把已经摘下的对象交给 Retire，等所有读者都离开更早的 epoch 之后才真正释放
+class EpochReclaimer {
+  public:
+    static constexpr size_t kMaxReaders = 256;  // 同时登记的读线程上限（超出时读者退回加锁）
+    static constexpr size_t kReclaimBatch = 64; // 待回收对象达到这个数量时尝试回收
+
+    static EpochReclaimer& Instance();
+
+    // 读临界区（RAII）：同一线程可以嵌套；槽位用完时 Active() 返回 false，调用方应退回加锁路径
+    class Guard {
+      public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        bool Active() const {
+            return active_;
+        }
+
+      private:
+        bool active_ = false;
+        bool outer_ = false; // 最外层的 Guard 负责登记和注销
+    };
+
+    // 延迟释放 object（调用前 object 必须已经对新读者不可见）
+    template <typename T>
+    void Retire(const T* object) {
+        RetireRaw(const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); });
+    }
+    // 等待当前所有读临界区结束（不能在 Guard 内调用）
+    void Synchronize();
+    // 尚未释放的对象数量
+    size_t PendingCount();
+
+  private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0}; // 0 表示不在临界区
+        std::atomic<bool> used{false};  // 槽位已被某个线程占用
+    };
+    struct Retired {
+        uint64_t epoch; // 摘下时的全局 epoch
+        void* object;
+        void (*deleter)(void*);
+    };
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+    size_t AcquireSlot();             // 为当前线程分配槽位（没有空闲槽位返回 kMaxReaders）
+    void ReleaseSlot(size_t index);   // 线程退出时归还槽位
+    void RetireRaw(void* object, void (*deleter)(void*));
+    void Reclaim();                   // 推进 epoch，释放所有读者都已离开的对象（持有 mutex_）
+    uint64_t MinActiveEpoch() const;  // 正在临界区中的最小 epoch（没有读者时返回 UINT64_MAX）
+
+    friend struct EpochThreadState;
+    std::atomic<uint64_t> global_epoch_{1};
+    Slot slots_[kMaxReaders];
+    std::mutex mutex_;              // 保护 retired_
+    std::vector<Retired> retired_;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+
+// 空闲块索引接口（不同分配策略的空闲空间组织方式）
+// 索引只记录空闲区间，块的使用状态仍以 used_map 为准
+class FreeBlockIndex {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    virtual ~FreeBlockIndex() = default;
+
+    virtual void Clear() = 0;                  // 清空索引（不保留任何空闲区间）
+    virtual void Reset(size_t blockCount) = 0; // 整个范围 [0, blockCount) 作为一个空闲区间
+
+    // 插入空闲区间并与相邻区间合并（区间必须当前不在索引中）
+    virtual void Insert(size_t start, size_t length) = 0;
+    // 从所在的空闲区间中挖去 [start, start + length)，剩余部分保留（区间必须完全空闲）
+    // head 为 start 所在空闲区间的首块（调用方从查找结果或位图得到，索引不再向前查找）
+    virtual bool Remove(size_t head, size_t start, size_t length) = 0;
+    // 查找长度 >= length 的空闲区间起始块，找不到返回 npos
+    virtual size_t Find(size_t length) const = 0;
+};
@@ -0,0 +1,84 @@
+#include "free_extent_index.h"
+#include <iterator>
+
+void FreeExtentIndex::Clear() {
+    by_length_.clear();
+    by_start_.clear();
+}
+
+void FreeExtentIndex::Reset(size_t blockCount) {
+    Clear();
+    if (blockCount > 0) {
+        Add(0, blockCount);
+    }
+}
+
+void FreeExtentIndex::Add(size_t start, size_t length) {
+    by_start_.emplace(start, length);
+    by_length_.emplace(length, start);
+}
+
+void FreeExtentIndex::Erase(std::map<size_t, size_t>::iterator it) {
+    by_length_.erase({it->second, it->first});
+    by_start_.erase(it);
+}
+
+void FreeExtentIndex::Insert(size_t start, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    // 只需检查紧邻的前后两个区间
+    auto next = by_start_.lower_bound(start);
+    if (next != by_start_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            length += prev->second;
+            Erase(prev);
+        }
+    }
+    if (next != by_start_.end() && next->first == start + length) {
+        length += next->second;
+        Erase(next);
+    }
+    Add(start, length);
+}
+
+bool FreeExtentIndex::Remove(size_t head, size_t start, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+
+    // 包含 start 的空闲区间从 head 开始
+    auto it = by_start_.find(head);
+    if (it == by_start_.end() || start < head) {
+        return false;
+    }
+    size_t extentStart = it->first;
+    size_t extentEnd = it->first + it->second;
+    if (start + length > extentEnd) {
+        return false;
+    }
+
+    Erase(it);
+    if (start > extentStart) {
+        Add(extentStart, start - extentStart);
+    }
+    if (start + length < extentEnd) {
+        Add(start + length, extentEnd - (start + length));
+    }
+    return true;
+}
+
+size_t FreeExtentIndex::Find(size_t length) const {
+    auto it = by_length_.lower_bound({length, 0});
+    if (it == by_length_.end()) {
+        return npos;
+    }
+    return it->second;
+}
+
+size_t FreeExtentIndex::LargestExtent() const {
+    return by_length_.empty() ? 0 : by_length_.rbegin()->first;
+}
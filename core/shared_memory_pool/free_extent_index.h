@@ -0,0 +1,32 @@
+#pragma once
+#include "free_block_index.h"
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+
+// 空闲区间索引（与 used_map 保持同步）
+//   by_length_：(长度, 起始块) 有序集合，用于 O(log n) 最佳适配查找
+//   by_start_ ：起始块 -> 长度，用于释放时与左右相邻空闲区间合并
+class FreeExtentIndex : public FreeBlockIndex {
+  public:
+    void Clear() override;
+    void Reset(size_t blockCount) override;
+    void Insert(size_t start, size_t length) override;
+    bool Remove(size_t head, size_t start, size_t length) override;
+
+    // 最佳适配：返回长度 >= length 的最小空闲区间起始块（同长度取地址最小者），找不到返回 npos
+    size_t Find(size_t length) const override;
+
+    size_t LargestExtent() const; // 最大空闲区间长度
+    size_t ExtentCount() const {  // 空闲区间数量
+        return by_start_.size();
+    }
+
+  private:
+    void Add(size_t start, size_t length);
+    void Erase(std::map<size_t, size_t>::iterator it);
+
+    std::set<std::pair<size_t, size_t>> by_length_; // (长度, 起始块)
+    std::map<size_t, size_t> by_start_;             // 起始块 -> 长度
+};
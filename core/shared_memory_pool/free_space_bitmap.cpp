@@ -0,0 +1,436 @@
+#include "free_space_bitmap.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+constexpr uint64_t kAllUsed = ~0ULL;
+
+// 位运算辅助函数（参数必须非 0）
+inline unsigned Ctz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned Clz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return 63u - static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_clzll(x));
+#endif
+}
+
+inline unsigned Popcount64(uint64_t x) {
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(x));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#endif
+}
+
+// 字内最长的连续 1（空闲位）游程
+unsigned LongestRun(uint64_t freeBits) {
+    unsigned best = 0;
+    while (freeBits) {
+        freeBits >>= Ctz64(freeBits);
+        uint64_t inv = ~freeBits;
+        unsigned len = inv ? Ctz64(inv) : 64;
+        best = std::max(best, len);
+        if (len >= 64) {
+            break;
+        }
+        freeBits >>= len;
+    }
+    return best;
+}
+
+// 字内查找至少 n 个连续 1（1 <= n <= 64），返回起始位，找不到返回 64
+// 每轮 x &= x >> s 后，第 i 位为 1 表示 [i, i+len) 全为 1，轮数为 O(log n)
+unsigned FindRunInWord(uint64_t freeBits, size_t n) {
+    uint64_t x = freeBits;
+    size_t len = 1;
+    while (len < n && x) {
+        size_t shift = std::min(len, n - len);
+        x &= x >> shift;
+        len += shift;
+    }
+    return x ? Ctz64(x) : 64;
+}
+} // namespace
+
+FreeSpaceBitmap::FreeSpaceBitmap(size_t bitCount) {
+    Resize(bitCount);
+}
+
+void FreeSpaceBitmap::Resize(size_t bitCount) {
+    bit_count_ = bitCount;
+    word_count_ = (bitCount + 63) / 64;
+    size_t groupCount = (word_count_ + 63) / 64;
+    size_t topCount = (groupCount + 63) / 64;
+
+    words_.assign(word_count_, 0);
+    full_.assign(groupCount, 0);
+    empty_.assign(groupCount, 0);
+    max_run_.assign(word_count_, 0);
+    full_groups_.assign(topCount, 0);
+
+    // 尾部填充位视为已使用，保证查找结果不会越界
+    if (bitCount & 63) {
+        words_.back() = kAllUsed << (bitCount & 63);
+    }
+    if (word_count_ & 63) {
+        full_.back() = kAllUsed << (word_count_ & 63);
+    }
+    if (groupCount & 63) {
+        full_groups_.back() = kAllUsed << (groupCount & 63);
+    }
+
+    for (size_t w = 0; w < word_count_; ++w) {
+        UpdateSummary(w);
+    }
+    ResetRunStats();
+}
+
+void FreeSpaceBitmap::Reset() {
+    Resize(bit_count_);
+}
+
+void FreeSpaceBitmap::UpdateSummary(size_t word) {
+    uint64_t value = words_[word];
+    size_t group = word >> 6;
+    uint64_t bit = 1ULL << (word & 63);
+
+    if (value == kAllUsed) {
+        full_[group] |= bit;
+    } else {
+        full_[group] &= ~bit;
+    }
+    if (value == 0) {
+        empty_[group] |= bit;
+    } else {
+        empty_[group] &= ~bit;
+    }
+    max_run_[word] = static_cast<uint8_t>(LongestRun(~value));
+
+    uint64_t groupBit = 1ULL << (group & 63);
+    if (full_[group] == kAllUsed) {
+        full_groups_[group >> 6] |= groupBit;
+    } else {
+        full_groups_[group >> 6] &= ~groupBit;
+    }
+}
+
+void FreeSpaceBitmap::Set(size_t pos, bool used) {
+    if (run_stats_) {
+        SetRange(pos, 1, used);
+        return;
+    }
+    size_t word = pos >> 6;
+    uint64_t bit = 1ULL << (pos & 63);
+    if (used) {
+        words_[word] |= bit;
+    } else {
+        words_[word] &= ~bit;
+    }
+    UpdateSummary(word);
+}
+
+void FreeSpaceBitmap::SetRange(size_t start, size_t count, bool used) {
+    size_t end = start + count;
+    // 受影响的范围扩展到两端相邻的空闲游程，修改前扣除其中的游程，修改后重新统计
+    size_t statsStart = start;
+    size_t statsEnd = end;
+    if (run_stats_ && count > 0) {
+        if (statsStart > 0 && !Test(statsStart - 1)) {
+            size_t prev = FindPrevUsed(statsStart - 1);
+            statsStart = (prev == npos) ? 0 : prev + 1;
+        }
+        if (statsEnd < bit_count_ && !Test(statsEnd)) {
+            statsEnd = FindNextUsed(statsEnd);
+        }
+        CountRuns(statsStart, statsEnd, false);
+    }
+    while (start < end) {
+        size_t word = start >> 6;
+        size_t offset = start & 63;
+        size_t bits = std::min<size_t>(64 - offset, end - start);
+        uint64_t mask = (bits == 64) ? kAllUsed : (((1ULL << bits) - 1) << offset);
+        if (used) {
+            words_[word] |= mask;
+        } else {
+            words_[word] &= ~mask;
+        }
+        UpdateSummary(word);
+        start += bits;
+    }
+    if (run_stats_ && count > 0) {
+        CountRuns(statsStart, statsEnd, true);
+    }
+}
+
+// 借助 L1/L2 汇总跳过已满的字
+size_t FreeSpaceBitmap::NextNonFullWord(size_t word) const {
+    while (word < word_count_) {
+        size_t group = word >> 6;
+        uint64_t bits = ~full_[group] & (kAllUsed << (word & 63));
+        if (bits) {
+            return std::min(word_count_, (group << 6) + Ctz64(bits));
+        }
+
+        // 当前组剩余部分已满，通过 L2 找下一个含空闲字的组
+        size_t nextGroup = group + 1;
+        while (nextGroup < full_.size()) {
+            size_t top = nextGroup >> 6;
+            uint64_t groupBits = ~full_groups_[top] & (kAllUsed << (nextGroup & 63));
+            if (groupBits) {
+                nextGroup = (top << 6) + Ctz64(groupBits);
+                break;
+            }
+            nextGroup = (top + 1) << 6;
+        }
+        if (nextGroup >= full_.size()) {
+            return word_count_;
+        }
+        word = nextGroup << 6;
+    }
+    return word_count_;
+}
+
+// 借助 L1 汇总跳过全空的字
+size_t FreeSpaceBitmap::NextNonEmptyWord(size_t word) const {
+    while (word < word_count_) {
+        size_t group = word >> 6;
+        uint64_t bits = ~empty_[group] & (kAllUsed << (word & 63));
+        if (bits) {
+            return std::min(word_count_, (group << 6) + Ctz64(bits));
+        }
+        word = (group + 1) << 6;
+    }
+    return word_count_;
+}
+
+// 借助 L1 汇总向前跳过全空的字
+size_t FreeSpaceBitmap::PrevNonEmptyWord(size_t word) const {
+    while (true) {
+        size_t group = word >> 6;
+        uint64_t bits = ~empty_[group] & (kAllUsed >> (63 - (word & 63)));
+        if (bits) {
+            return (group << 6) + 63 - Clz64(bits);
+        }
+        if (group == 0) {
+            return npos;
+        }
+        word = (group << 6) - 1;
+    }
+}
+
+size_t FreeSpaceBitmap::FindFreeRun(size_t count, size_t from) const {
+    if (count == 0 || count > bit_count_ || from >= bit_count_) {
+        return npos;
+    }
+
+    size_t word = from >> 6;
+    // 起始字中 from 之前的位视为已使用
+    uint64_t headMask = (from & 63) ? ((1ULL << (from & 63)) - 1) : 0;
+    size_t run = 0;      // 跨字累积的空闲游程长度
+    size_t runStart = 0; // 累积游程的起始位置
+
+    while (word < word_count_) {
+        uint64_t value = words_[word] | headMask;
+        headMask = 0;
+
+        if (value == kAllUsed) {
+            run = 0;
+            word = NextNonFullWord(word + 1);
+            continue;
+        }
+
+        if (value == 0) {
+            if (run == 0) {
+                runStart = word << 6;
+            }
+            size_t next = NextNonEmptyWord(word + 1);
+            run += (next - word) << 6;
+            if (run >= count) {
+                return runStart;
+            }
+            word = next;
+            continue;
+        }
+
+        // 混合字：先尝试与前面的游程拼接（字的低位空闲部分）
+        size_t lead = Ctz64(value);
+        if (run + lead >= count) {
+            return run ? runStart : (word << 6);
+        }
+
+        // 再尝试字内部的游程
+        if (count <= 64 && max_run_[word] >= count) {
+            unsigned pos = FindRunInWord(~value, count);
+            if (pos < 64) {
+                return (word << 6) + pos;
+            }
+        }
+
+        // 字的高位空闲部分作为新游程的开头
+        size_t tail = Clz64(value);
+        run = tail;
+        runStart = (word << 6) + 64 - tail;
+        ++word;
+    }
+    return npos;
+}
+
+size_t FreeSpaceBitmap::FindNextUsed(size_t from) const {
+    if (from >= bit_count_) {
+        return bit_count_;
+    }
+    size_t word = from >> 6;
+    uint64_t value = words_[word] & (kAllUsed << (from & 63));
+    while (!value) {
+        word = NextNonEmptyWord(word + 1);
+        if (word >= word_count_) {
+            return bit_count_;
+        }
+        value = words_[word];
+    }
+    return std::min(bit_count_, (word << 6) + Ctz64(value));
+}
+
+size_t FreeSpaceBitmap::FindPrevUsed(size_t pos) const {
+    if (pos >= bit_count_) {
+        return npos;
+    }
+    size_t word = pos >> 6;
+    uint64_t value = words_[word] & (kAllUsed >> (63 - (pos & 63)));
+    while (!value) {
+        if (word == 0) {
+            return npos;
+        }
+        word = PrevNonEmptyWord(word - 1);
+        if (word == npos) {
+            return npos;
+        }
+        value = words_[word];
+    }
+    return (word << 6) + 63 - Clz64(value);
+}
+
+size_t FreeSpaceBitmap::MaxFreeRun() const {
+    if (run_stats_) {
+        return run_lengths_.empty() ? 0 : run_lengths_.rbegin()->first;
+    }
+    size_t best = 0;
+    size_t run = 0;
+    size_t word = 0;
+    while (word < word_count_) {
+        uint64_t value = words_[word];
+        if (value == kAllUsed) {
+            run = 0;
+            word = NextNonFullWord(word + 1);
+            continue;
+        }
+        if (value == 0) {
+            size_t next = NextNonEmptyWord(word + 1);
+            run += (next - word) << 6;
+            best = std::max(best, run);
+            word = next;
+            continue;
+        }
+        run += Ctz64(value);
+        best = std::max(best, run);
+        best = std::max<size_t>(best, max_run_[word]);
+        run = Clz64(value);
+        ++word;
+    }
+    return std::max(best, run);
+}
+
+size_t FreeSpaceBitmap::CountFreeRuns() const {
+    if (run_stats_) {
+        return run_count_;
+    }
+    size_t runs = 0;
+    uint64_t carry = 0; // 上一个字最高位是否空闲
+    for (size_t word = 0; word < word_count_; ++word) {
+        uint64_t freeBits = ~words_[word];
+        // 游程起点：当前位空闲且前一位已使用
+        runs += Popcount64(freeBits & ~((freeBits << 1) | carry));
+        carry = freeBits >> 63;
+    }
+    return runs;
+}
+
+size_t FreeSpaceBitmap::CountUsed() const {
+    size_t used = 0;
+    for (uint64_t value : words_) {
+        used += Popcount64(value);
+    }
+    // 扣除尾部填充位
+    return used - (word_count_ * 64 - bit_count_);
+}
+
+size_t FreeSpaceBitmap::CountUsed(size_t start, size_t count) const {
+    size_t used = 0;
+    size_t end = start + count;
+    while (start < end) {
+        size_t word = start >> 6;
+        size_t offset = start & 63;
+        size_t bits = std::min<size_t>(64 - offset, end - start);
+        uint64_t mask = (bits == 64) ? kAllUsed : (((1ULL << bits) - 1) << offset);
+        used += Popcount64(words_[word] & mask);
+        start += bits;
+    }
+    return used;
+}
+
+void FreeSpaceBitmap::EnableRunStats() {
+    run_stats_ = true;
+    ResetRunStats();
+}
+
+void FreeSpaceBitmap::ResetRunStats() {
+    run_count_ = 0;
+    run_buckets_.fill(0);
+    run_lengths_.clear();
+    if (run_stats_) {
+        CountRuns(0, bit_count_, true);
+    }
+}
+
+void FreeSpaceBitmap::CountRuns(size_t start, size_t end, bool add) {
+    while (start < end) {
+        size_t runStart = FindFreeRun(1, start);
+        if (runStart == npos || runStart >= end) {
+            break;
+        }
+        size_t runEnd = std::min(FindNextUsed(runStart), end);
+        AdjustRun(runEnd - runStart, add);
+        start = runEnd;
+    }
+}
+
+void FreeSpaceBitmap::AdjustRun(size_t length, bool add) {
+    size_t bucket = std::min<size_t>(63 - Clz64(length), kRunBucketCount - 1);
+    if (add) {
+        ++run_count_;
+        ++run_buckets_[bucket];
+        ++run_lengths_[length];
+        return;
+    }
+    --run_count_;
+    --run_buckets_[bucket];
+    auto it = run_lengths_.find(length);
+    if (--it->second == 0) {
+        run_lengths_.erase(it);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <map>
+#include <vector>
+
+// 分层空闲位图（替代 std::bitset 逐位扫描）
+//   L0 words_       ：每位对应一个块（1 = 已使用）
+//   L1 full_        ：每位对应一个 L0 字（1 = 该字 64 个块全部已使用）
+//   L1 empty_       ：每位对应一个 L0 字（1 = 该字 64 个块全部空闲）
+//   L1 max_run_     ：每个 L0 字内部最长的空闲游程（0-64）
+//   L2 full_groups_ ：每位对应一个 full_ 字（1 = 该组 64 个字全部已使用）
+// 查找时按字跳过已满/全空的区域，字内使用 ctz/clz/popcount 定位
+// 开启空闲游程统计后，每次修改只重新统计被修改区间及两端相邻的空闲游程
+class FreeSpaceBitmap {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t kRunBucketCount = 32; // 第 i 桶：长度在 [2^i, 2^(i+1)) 的游程
+    using RunHistogram = std::array<size_t, kRunBucketCount>;
+
+    explicit FreeSpaceBitmap(size_t bitCount = 0);
+
+    void Resize(size_t bitCount); // 重新设置位数（全部置为空闲）
+    void Reset();                 // 全部置为空闲
+    size_t Size() const {
+        return bit_count_;
+    }
+
+    bool Test(size_t pos) const {
+        return (words_[pos >> 6] >> (pos & 63)) & 1ULL;
+    }
+    bool operator[](size_t pos) const {
+        return Test(pos);
+    }
+    void Set(size_t pos, bool used = true);
+    void SetRange(size_t start, size_t count, bool used); // 按字批量设置
+
+    // 从 from 开始查找至少 count 个连续空闲位，返回起始位置（找不到返回 npos）
+    size_t FindFreeRun(size_t count, size_t from = 0) const;
+    // 从 from 开始查找下一个已使用位，找不到返回 Size()
+    size_t FindNextUsed(size_t from) const;
+    // 从 pos 开始向前查找上一个已使用位（含 pos），找不到返回 npos
+    size_t FindPrevUsed(size_t pos) const;
+    size_t MaxFreeRun() const;    // 最长连续空闲游程（开启统计后 O(log n)）
+    size_t CountFreeRuns() const; // 空闲游程（碎片）数量（开启统计后 O(1)）
+
+    // 开启空闲游程统计（增量维护游程数量、长度分布和按 2 的幂分桶的直方图）
+    void EnableRunStats();
+    bool HasRunStats() const {
+        return run_stats_;
+    }
+    const RunHistogram& GetRunHistogram() const {
+        return run_buckets_;
+    }
+    size_t CountUsed() const;     // 已使用位数量
+    size_t CountUsed(size_t start, size_t count) const; // 区间内已使用位数量
+
+  private:
+    void UpdateSummary(size_t word); // 重新计算某个字的 L1/L2 汇总信息
+    size_t NextNonFullWord(size_t word) const;
+    size_t NextNonEmptyWord(size_t word) const;
+    size_t PrevNonEmptyWord(size_t word) const;
+    // 统计 [start, end) 中的空闲游程（两端的游程必须完整），add 为 false 时从统计中扣除
+    void CountRuns(size_t start, size_t end, bool add);
+    void AdjustRun(size_t length, bool add);
+    void ResetRunStats();
+
+    size_t bit_count_ = 0;
+    size_t word_count_ = 0;
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> full_;
+    std::vector<uint64_t> empty_;
+    std::vector<uint8_t> max_run_;
+    std::vector<uint64_t> full_groups_;
+    // 空闲游程统计
+    bool run_stats_ = false;
+    size_t run_count_ = 0;
+    RunHistogram run_buckets_{};
+    std::map<size_t, size_t> run_lengths_; // 游程长度 -> 数量（最大值即最长游程）
+};
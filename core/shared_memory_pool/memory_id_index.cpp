@@ -0,0 +1,185 @@
+#include "memory_id_index.h"
+#include <algorithm>
+
+namespace {
+const char kPrefix[] = "memory_";
+const size_t kPrefixLength = sizeof(kPrefix) - 1;
+const char kBase62Chars[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const size_t kMaxDigits = 10; // 62^10 < 2^64，更长的编号不按整数索引
+
+// 编号对应的标准位数
+size_t DigitCount(uint64_t number) {
+    size_t digits = 1;
+    for (uint64_t rest = number / 62; rest > 0; rest /= 62) {
+        ++digits;
+    }
+    if (number >= 56800235584ULL) { // 62^6
+        return std::max<size_t>(digits, 7);
+    }
+    if (number >= 916132832ULL) { // 62^5
+        return std::max<size_t>(digits, 6);
+    }
+    return std::max<size_t>(digits, 5);
+}
+
+int Base62Value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return 10 + (c - 'a');
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return 36 + (c - 'A');
+    }
+    return -1;
+}
+} // namespace
+
+// 从低位向高位填充固定长度的缓冲区，避免逐字符拼接字符串
+std::string MemoryIdIndex::FormatId(uint64_t number) {
+    size_t digits = DigitCount(number);
+    std::string result(kPrefixLength + digits, '0');
+    std::copy(kPrefix, kPrefix + kPrefixLength, result.begin());
+    for (size_t pos = result.size(); number > 0; number /= 62) {
+        result[--pos] = kBase62Chars[number % 62];
+    }
+    return result;
+}
+
+bool MemoryIdIndex::ParseId(const std::string& memory_id, uint64_t& number) {
+    size_t digits = memory_id.size() - kPrefixLength;
+    if (memory_id.size() <= kPrefixLength || digits > kMaxDigits ||
+        memory_id.compare(0, kPrefixLength, kPrefix) != 0) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t i = kPrefixLength; i < memory_id.size(); ++i) {
+        int digit = Base62Value(memory_id[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = value * 62 + static_cast<uint64_t>(digit);
+    }
+    // 位数必须与生成时一致，"memory_000001" 与 "memory_00001" 是不同的 ID
+    if (DigitCount(value) != digits) {
+        return false;
+    }
+    number = value;
+    return true;
+}
+
+// 乘法哈希取高位（连续编号分散到整个表）
+size_t MemoryIdIndex::Home(uint64_t number) const {
+    uint64_t hash = number * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash >> 32) & (slots_.size() - 1);
+}
+
+uint32_t MemoryIdIndex::Find(const std::string& memory_id) const {
+    uint64_t number = 0;
+    if (!ParseId(memory_id, number)) {
+        auto it = others_.find(memory_id);
+        return it == others_.end() ? npos : it->second;
+    }
+    if (slots_.empty()) {
+        return npos;
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t pos = Home(number);; pos = (pos + 1) & mask) {
+        const Slot& slot = slots_[pos];
+        if (slot.index == npos) {
+            return npos;
+        }
+        if (slot.number == number) {
+            return slot.index;
+        }
+    }
+}
+
+void MemoryIdIndex::Insert(const std::string& memory_id, uint32_t index) {
+    uint64_t number = 0;
+    if (!ParseId(memory_id, number)) {
+        others_[memory_id] = index;
+        return;
+    }
+    if ((count_ + 1) * 2 > slots_.size()) {
+        Rehash(std::max<size_t>(slots_.size() * 2, 64));
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t pos = Home(number);; pos = (pos + 1) & mask) {
+        Slot& slot = slots_[pos];
+        if (slot.index == npos) {
+            slot.number = number;
+            slot.index = index;
+            ++count_;
+            return;
+        }
+        if (slot.number == number) {
+            slot.index = index;
+            return;
+        }
+    }
+}
+
+// 删除后把同一探测链上后面的元素前移（不使用墓碑，查找链不会越来越长）
+void MemoryIdIndex::Erase(const std::string& memory_id) {
+    uint64_t number = 0;
+    if (!ParseId(memory_id, number)) {
+        others_.erase(memory_id);
+        return;
+    }
+    if (slots_.empty()) {
+        return;
+    }
+    size_t mask = slots_.size() - 1;
+    size_t hole = Home(number);
+    while (slots_[hole].index != npos && slots_[hole].number != number) {
+        hole = (hole + 1) & mask;
+    }
+    if (slots_[hole].index == npos) {
+        return;
+    }
+    for (size_t pos = (hole + 1) & mask; slots_[pos].index != npos; pos = (pos + 1) & mask) {
+        // 初始位置不在 (hole, pos] 内的元素可以移到空位
+        size_t home = Home(slots_[pos].number);
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            slots_[hole] = slots_[pos];
+            hole = pos;
+        }
+    }
+    slots_[hole] = Slot{};
+    --count_;
+}
+
+void MemoryIdIndex::Clear() {
+    slots_.clear();
+    count_ = 0;
+    others_.clear();
+}
+
+uint64_t MemoryIdIndex::MaxNumber() const {
+    uint64_t maxNumber = 0;
+    for (const Slot& slot : slots_) {
+        if (slot.index != npos) {
+            maxNumber = std::max(maxNumber, slot.number);
+        }
+    }
+    return maxNumber;
+}
+
+void MemoryIdIndex::Rehash(size_t capacity) {
+    std::vector<Slot> old;
+    old.swap(slots_);
+    slots_.assign(capacity, Slot{});
+    size_t mask = capacity - 1;
+    for (const Slot& slot : old) {
+        if (slot.index == npos) {
+            continue;
+        }
+        size_t pos = Home(slot.number);
+        while (slots_[pos].index != npos) {
+            pos = (pos + 1) & mask;
+        }
+        slots_[pos] = slot;
+    }
+}
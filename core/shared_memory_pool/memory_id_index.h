@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Memory ID 索引：内存ID -> 分配记录下标
+// 标准格式的 ID（"memory_" 加 Base62 编号）解码成整数编号，放入开放寻址哈希表（线性探测），
+// 查找只需一次解码和整数比较；其他格式的 ID（旧数据文件等）放入字符串哈希表
+class MemoryIdIndex {
+  public:
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+    // 编号 -> 标准格式的 ID（Base62 至少 5 位，超过 62^5、62^6 时分别扩展到 6、7 位）
+    static std::string FormatId(uint64_t number);
+    // 标准格式的 ID -> 编号；前导 0 多余或不足、含无效字符时返回 false
+    static bool ParseId(const std::string& memory_id, uint64_t& number);
+
+    uint32_t Find(const std::string& memory_id) const; // 不存在返回 npos
+    bool Contains(const std::string& memory_id) const {
+        return Find(memory_id) != npos;
+    }
+    void Insert(const std::string& memory_id, uint32_t index); // 已存在时覆盖
+    void Erase(const std::string& memory_id);
+    void Clear();
+    size_t Size() const {
+        return count_ + others_.size();
+    }
+    uint64_t MaxNumber() const; // 最大编号（没有标准格式的 ID 时返回 0）
+
+  private:
+    struct Slot {
+        uint64_t number = 0;
+        uint32_t index = npos; // npos 表示空槽
+    };
+    size_t Home(uint64_t number) const; // 编号的初始探测位置
+    void Rehash(size_t capacity);
+
+    std::vector<Slot> slots_; // 容量为 2 的幂，负载不超过 1/2
+    size_t count_ = 0;        // 哈希表中的 ID 数量
+    std::unordered_map<std::string, uint32_t> others_; // 非标准格式的 ID
+};
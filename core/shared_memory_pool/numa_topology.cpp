@@ -0,0 +1,234 @@
+#include "numa_topology.h"
+#include "page_memory.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0601 // Windows 7 or later for processor groups
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace NumaTopology {
+namespace {
+#ifndef _WIN32
+// 解析 sysfs 中的编号列表（例如 "0-3,8-11"）
+std::vector<size_t> ParseList(const std::string& text) {
+    std::vector<size_t> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string item = text.substr(pos, end - pos);
+        size_t dash = item.find('-');
+        try {
+            size_t first = std::stoul(item.substr(0, dash));
+            size_t last = (dash == std::string::npos) ? first : std::stoul(item.substr(dash + 1));
+            for (size_t value = first; value <= last; ++value) {
+                values.push_back(value);
+            }
+        } catch (...) {
+            // 忽略无法解析的部分（例如结尾的换行）
+        }
+        pos = end + 1;
+    }
+    return values;
+}
+
+std::vector<size_t> ReadList(const std::string& path) {
+    std::ifstream file(path);
+    std::string text;
+    std::getline(file, text);
+    return ParseList(text);
+}
+
+// 节点数量与 CPU -> 节点映射（进程内只读取一次）
+struct Topology {
+    size_t node_count = 1;
+    std::vector<size_t> cpu_node; // 下标为 CPU 编号
+};
+
+const Topology& GetTopology() {
+    static const Topology topology = [] {
+        Topology result;
+        std::vector<size_t> online = ReadList("/sys/devices/system/node/online");
+        if (online.empty()) {
+            return result;
+        }
+        result.node_count = std::min(*std::max_element(online.begin(), online.end()) + 1,
+                                     kMaxNodes);
+        for (size_t node = 0; node < result.node_count; ++node) {
+            for (size_t cpu : ReadList("/sys/devices/system/node/node" + std::to_string(node) +
+                                       "/cpulist")) {
+                if (cpu >= result.cpu_node.size()) {
+                    result.cpu_node.resize(cpu + 1, 0);
+                }
+                result.cpu_node[cpu] = node;
+            }
+        }
+        return result;
+    }();
+    return topology;
+}
+#endif
+} // namespace
+
+size_t NodeCount() {
+#ifdef _WIN32
+    static const size_t count = [] {
+        ULONG highest = 0;
+        if (!GetNumaHighestNodeNumber(&highest)) {
+            return static_cast<size_t>(1);
+        }
+        return std::min(static_cast<size_t>(highest) + 1, kMaxNodes);
+    }();
+    return count;
+#else
+    return GetTopology().node_count;
+#endif
+}
+
+size_t CurrentNode() {
+    if (NodeCount() == 1) {
+        return 0;
+    }
+#ifdef _WIN32
+    PROCESSOR_NUMBER processor;
+    GetCurrentProcessorNumberEx(&processor);
+    USHORT node = 0;
+    if (!GetNumaProcessorNodeEx(&processor, &node) || node >= NodeCount()) {
+        return 0;
+    }
+    return node;
+#else
+    const Topology& topology = GetTopology();
+    int cpu = sched_getcpu();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= topology.cpu_node.size()) {
+        return 0;
+    }
+    return topology.cpu_node[cpu];
+#endif
+}
+
+bool PinThreadToNode(size_t node) {
+    if (NodeCount() == 1) {
+        return true;
+    }
+    if (node >= NodeCount()) {
+        return false;
+    }
+#ifdef _WIN32
+    GROUP_AFFINITY affinity{};
+    return GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) &&
+           affinity.Mask != 0 && SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr);
+#else
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    const Topology& topology = GetTopology();
+    bool any = false;
+    for (size_t cpu = 0; cpu < topology.cpu_node.size() && cpu < CPU_SETSIZE; ++cpu) {
+        if (topology.cpu_node[cpu] == node) {
+            CPU_SET(cpu, &cpus);
+            any = true;
+        }
+    }
+    // pid 0 表示调用线程
+    return any && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#endif
+}
+
+bool BindMemory(void* addr, size_t size, int node) {
+    if (node == kAnyNode || NodeCount() == 1) {
+        return true;
+    }
+    if (node >= static_cast<int>(NodeCount())) {
+        return false;
+    }
+#if !defined(_WIN32) && defined(SYS_mbind)
+    // MPOL_PREFERRED：优先在该节点分配，节点内存不足时退回其他节点
+    const int kPreferred = 1;
+    const int kInterleaveMode = 3;
+    const size_t kBitsPerWord = sizeof(unsigned long) * 8;
+    unsigned long mask[kMaxNodes / kBitsPerWord] = {};
+    if (node == kInterleave) {
+        for (size_t i = 0; i < NodeCount(); ++i) {
+            mask[i / kBitsPerWord] |= 1UL << (i % kBitsPerWord);
+        }
+    } else {
+        mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    }
+    int mode = (node == kInterleave) ? kInterleaveMode : kPreferred;
+    return syscall(SYS_mbind, addr, size, mode, mask, kMaxNodes + 1, 0) == 0;
+#else
+    (void)addr;
+    (void)size;
+    return false;
+#endif
+}
+
+std::vector<size_t> GetResidentBytesByNode(const void* addr, size_t size) {
+    std::vector<size_t> bytes(NodeCount(), 0);
+    const size_t pageSize = PageMemory::PageSize();
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(addr) / pageSize * pageSize;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+    const size_t kBatchPages = 1024; // 每次查询的页数
+#ifdef _WIN32
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> pages(kBatchPages);
+    for (uintptr_t pos = begin; pos < end;) {
+        size_t count = std::min(kBatchPages, static_cast<size_t>((end - pos + pageSize - 1) /
+                                                                 pageSize));
+        for (size_t i = 0; i < count; ++i) {
+            pages[i].VirtualAddress = reinterpret_cast<void*>(pos + i * pageSize);
+        }
+        if (!QueryWorkingSetEx(GetCurrentProcess(), pages.data(),
+                               static_cast<DWORD>(count * sizeof(pages[0])))) {
+            return {};
+        }
+        for (size_t i = 0; i < count; ++i) {
+            size_t node = pages[i].VirtualAttributes.Node;
+            if (pages[i].VirtualAttributes.Valid && node < bytes.size()) {
+                bytes[node] += pageSize;
+            }
+        }
+        pos += count * pageSize;
+    }
+    return bytes;
+#elif defined(SYS_move_pages)
+    // move_pages 不传目标节点时只查询：status 为页面所在节点，未驻留的页面为负的错误码
+    std::vector<void*> pages(kBatchPages);
+    std::vector<int> status(kBatchPages);
+    for (uintptr_t pos = begin; pos < end;) {
+        size_t count = std::min(kBatchPages, static_cast<size_t>((end - pos + pageSize - 1) /
+                                                                 pageSize));
+        for (size_t i = 0; i < count; ++i) {
+            pages[i] = reinterpret_cast<void*>(pos + i * pageSize);
+        }
+        if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) {
+            return {};
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (status[i] >= 0 && static_cast<size_t>(status[i]) < bytes.size()) {
+                bytes[status[i]] += pageSize;
+            }
+        }
+        pos += count * pageSize;
+    }
+    return bytes;
+#else
+    (void)begin;
+    (void)end;
+    (void)kBatchPages;
+    return {};
+#endif
+}
+} // namespace NumaTopology
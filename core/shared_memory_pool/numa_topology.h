@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// NUMA 拓扑与内存放置
+//   Windows：GetNumaHighestNodeNumber / GetNumaNodeProcessorMaskEx / QueryWorkingSetEx
+//   Linux：/sys/devices/system/node、sched_getcpu、mbind / move_pages 系统调用（不依赖 libnuma）
+// 单节点或不支持 NUMA 的平台上节点数量为 1，绑定和固定线程都不做任何事
+namespace NumaTopology {
+constexpr int kAnyNode = -1;    // 不指定节点（页面落在首次写入的线程所在节点，系统默认行为）
+constexpr int kInterleave = -2; // 页面轮流分布到所有节点
+constexpr size_t kMaxNodes = 64; // 支持的节点数量上限
+
+// 节点数量（至少为 1）
+size_t NodeCount();
+// 当前线程所在 CPU 的节点（单节点或无法查询时为 0）
+size_t CurrentNode();
+// 把当前线程固定到节点的 CPU 上（单节点时不固定，返回 true）
+bool PinThreadToNode(size_t node);
+// 设置区间的内存放置策略（node 为节点号时优先在该节点分配，kInterleave 时轮流分布），
+// 须在页面首次写入之前调用，只影响之后分配的物理页；不支持时返回 false
+// （Windows 在映射时指定节点，见 PageMemory::Map）
+bool BindMemory(void* addr, size_t size, int node);
+// 区间内已驻留的物理页按节点统计的字节数（大小为 NodeCount()，无法查询时返回空数组）
+std::vector<size_t> GetResidentBytesByNode(const void* addr, size_t size);
+} // namespace NumaTopology
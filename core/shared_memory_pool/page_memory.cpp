@@ -0,0 +1,225 @@
+#include "page_memory.h"
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600 // Windows Vista or later for VirtualAllocExNuma
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace PageMemory {
+namespace {
+size_t RoundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+#ifdef _WIN32
+// 使用大页需要进程拥有并启用 SeLockMemoryPrivilege（“锁定内存页”）
+bool EnableLockMemoryPrivilege() {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+    TOKEN_PRIVILEGES privileges{};
+    privileges.PrivilegeCount = 1;
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    bool ok = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege",
+                                    &privileges.Privileges[0].Luid) &&
+              AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+              GetLastError() == ERROR_SUCCESS;
+    CloseHandle(token);
+    return ok;
+}
+#else
+void* MapAnonymous(size_t size, int extraFlags) {
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+    return (addr == MAP_FAILED) ? nullptr : addr;
+}
+#endif
+} // namespace
+
+const char* GetBackingName(Backing backing) {
+    switch (backing) {
+    case Backing::kTransparentHuge:
+        return "transparent huge pages";
+    case Backing::kHugeTlb:
+        return "explicit huge pages";
+    case Backing::kShared:
+        return "shared segment";
+    case Backing::kStandard:
+    default:
+        return "standard pages";
+    }
+}
+
+size_t PageSize() {
+    static const size_t pageSize = [] {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#else
+        long size = sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t>(size) : static_cast<size_t>(4096);
+#endif
+    }();
+    return pageSize;
+}
+
+size_t HugePageSize() {
+#ifdef _WIN32
+    static const size_t hugePageSize = [] {
+        size_t size = GetLargePageMinimum();
+        return size > 0 ? size : static_cast<size_t>(2 * 1024 * 1024);
+    }();
+    return hugePageSize;
+#else
+    return 2 * 1024 * 1024;
+#endif
+}
+
+namespace {
+#ifdef _WIN32
+// 指定了节点时用 VirtualAllocExNuma（节点内存不足时系统会退回其他节点）
+void* AllocateOnNode(size_t size, DWORD type, int node) {
+    if (node >= 0 && NumaTopology::NodeCount() > 1) {
+        return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, type, PAGE_READWRITE,
+                                  static_cast<DWORD>(node));
+    }
+    return VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+}
+#endif
+
+void* MapPages(size_t size, bool hugePages, Backing* backing, int node) {
+#ifdef _WIN32
+    if (hugePages && EnableLockMemoryPrivilege()) {
+        // 大页在提交时即占用物理内存（不能按需分配，也不能单独归还）
+        void* addr = AllocateOnNode(RoundUp(size, HugePageSize()),
+                                    MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, node);
+        if (addr) {
+            if (backing) {
+                *backing = Backing::kHugeTlb;
+            }
+            return addr;
+        }
+    }
+    // 提交的页面在首次访问时才分配物理内存，并由系统清零
+    return AllocateOnNode(size, MEM_RESERVE | MEM_COMMIT, node);
+#else
+    (void)node; // 映射之后由 Map 设置放置策略
+    if (!hugePages) {
+        return MapAnonymous(size, 0);
+    }
+    const size_t hugePageSize = HugePageSize();
+#ifdef MAP_HUGETLB
+    // 1. 显式大页（需要预留大页：/proc/sys/vm/nr_hugepages）
+    if (void* addr = MapAnonymous(RoundUp(size, hugePageSize), MAP_HUGETLB)) {
+        if (backing) {
+            *backing = Backing::kHugeTlb;
+        }
+        return addr;
+    }
+#endif
+    // 2. 透明大页：多映射一个大页，裁掉首尾使起始地址和长度都按大页对齐
+    size_t alignedSize = RoundUp(size, hugePageSize);
+    size_t mappedSize = alignedSize + hugePageSize;
+    uint8_t* raw = static_cast<uint8_t*>(MapAnonymous(mappedSize, 0));
+    if (!raw) {
+        return nullptr;
+    }
+    uint8_t* addr =
+        reinterpret_cast<uint8_t*>(RoundUp(reinterpret_cast<uintptr_t>(raw), hugePageSize));
+    if (addr > raw) {
+        munmap(raw, addr - raw);
+    }
+    munmap(addr + alignedSize, (raw + mappedSize) - (addr + alignedSize));
+#ifdef MADV_HUGEPAGE
+    if (madvise(addr, alignedSize, MADV_HUGEPAGE) == 0) {
+        if (backing) {
+            *backing = Backing::kTransparentHuge;
+        }
+        return addr;
+    }
+#endif
+    // 透明大页不可用，按普通页长度裁掉多余部分
+    size_t standardSize = RoundUp(size, PageSize());
+    if (standardSize < alignedSize) {
+        munmap(addr + standardSize, alignedSize - standardSize);
+    }
+    return addr;
+#endif
+}
+} // namespace
+
+void* Map(size_t size, bool hugePages, Backing* backing, int node) {
+    if (backing) {
+        *backing = Backing::kStandard;
+    }
+    if (size == 0) {
+        return nullptr;
+    }
+    void* addr = MapPages(size, hugePages, backing, node);
+#ifndef _WIN32
+    // 页面还没有写入过，设置放置策略后首次写入时按策略分配（失败时保持系统默认）
+    if (addr && node != NumaTopology::kAnyNode) {
+        Backing actual = backing ? *backing : Backing::kStandard;
+        NumaTopology::BindMemory(
+            addr, RoundUp(size, (actual == Backing::kStandard) ? PageSize() : HugePageSize()),
+            node);
+    }
+#endif
+    return addr;
+}
+
+void Unmap(void* addr, size_t size, Backing backing) {
+    if (!addr || backing == Backing::kShared) {
+        return;
+    }
+#ifdef _WIN32
+    (void)size;
+    (void)backing;
+    VirtualFree(addr, 0, MEM_RELEASE);
+#else
+    // 大页映射的长度按大页取整
+    size = RoundUp(size, (backing == Backing::kStandard) ? PageSize() : HugePageSize());
+    munmap(addr, size);
+#endif
+}
+
+bool Discard(void* addr, size_t size, Backing backing) {
+    if (!addr || size == 0) {
+        return true;
+    }
+#ifdef _WIN32
+    // 大页不能取消提交，页面文件支持的共享段也不能单独归还
+    if (backing == Backing::kHugeTlb || backing == Backing::kShared) {
+        return false;
+    }
+    // 先取消提交（丢弃物理页），再重新提交为零页
+    if (!VirtualFree(addr, size, MEM_DECOMMIT)) {
+        return false;
+    }
+    return VirtualAlloc(addr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#elif defined(__linux__)
+    // 共享段需要在共享内存文件中打洞（MADV_DONTNEED 只解除本进程的映射，不清零）
+    if (backing == Backing::kShared) {
+        return madvise(addr, size, MADV_REMOVE) == 0;
+    }
+    // 私有匿名映射在 MADV_DONTNEED 之后再次访问时读到零页
+    return madvise(addr, size, MADV_DONTNEED) == 0;
+#else
+    if (backing == Backing::kShared) {
+        return false;
+    }
+    // 其他平台 MADV_DONTNEED 不保证清零，用 MAP_FIXED 重新映射原区间
+    void* result = mmap(addr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    return result != MAP_FAILED;
+#endif
+}
+} // namespace PageMemory
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include "numa_topology.h"
+
+// 按页向操作系统申请内存池空间（匿名映射，页面首次写入时才真正占用物理内存）
+//   Windows：VirtualAlloc / VirtualFree
+//   其他平台：mmap / madvise / munmap
+namespace PageMemory {
+// 内存池的页面类型
+enum class Backing {
+    kStandard,        // 普通页
+    kTransparentHuge, // 透明大页（madvise(MADV_HUGEPAGE)，由内核按需合并为 2MB 页）
+    kHugeTlb,         // 显式大页（Linux MAP_HUGETLB / Windows MEM_LARGE_PAGES）
+    kShared,          // 跨进程共享段（SharedSegment，由段负责映射和释放）
+};
+const char* GetBackingName(Backing backing);
+
+// 系统页大小（字节）
+size_t PageSize();
+// 大页大小（字节，Linux 为 2MB，Windows 为 GetLargePageMinimum()）
+size_t HugePageSize();
+
+// 申请 size 字节的零页内存，失败返回 nullptr
+// hugePages 为 true 时依次尝试显式大页、透明大页，都不可用时退回普通页；实际类型写入 backing
+// node 为 NUMA 节点号时页面优先分配在该节点，NumaTopology::kInterleave 时轮流分布到所有节点
+// （Windows 不支持轮流分布），默认 kAnyNode 不指定；单节点机器上忽略
+void* Map(size_t size, bool hugePages = false, Backing* backing = nullptr,
+          int node = NumaTopology::kAnyNode);
+
+// 释放 Map 申请的内存（backing 须与 Map 返回的一致）
+void Unmap(void* addr, size_t size, Backing backing = Backing::kStandard);
+
+// 将区间清零并归还物理页（之后读取为 0，再次写入时才重新占用），addr 须按页（大页）对齐
+// 不支持归还时返回 false（例如 Windows 大页），内存内容保持不变
+bool Discard(void* addr, size_t size, Backing backing = Backing::kStandard);
+} // namespace PageMemory
@@ -0,0 +1,115 @@
+#include "read_index.h"
+#include "epoch_reclaimer.h"
+#include <algorithm>
+
+namespace {
+const size_t kMinCapacity = 64;
+} // namespace
+
+ReadIndex::ReadIndex() : table_(new Table(kMinCapacity)) {}
+
+// 销毁时不应再有读者，直接释放
+ReadIndex::~ReadIndex() {
+    for (const Entry* entry : by_record_) {
+        delete entry;
+    }
+    delete table_.load();
+}
+
+// 乘法哈希取高位（与 MemoryIdIndex 相同，连续编号分散到整个表）
+size_t ReadIndex::Home(uint64_t number, size_t mask) {
+    uint64_t hash = number * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash >> 32) & mask;
+}
+
+const ReadIndex::Entry* ReadIndex::Find(uint64_t number) const {
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (size_t pos = Home(number, table->mask);; pos = (pos + 1) & table->mask) {
+        const Slot& slot = table->slots[pos];
+        uint64_t current = slot.number.load(std::memory_order_acquire);
+        if (current == 0) {
+            return nullptr;
+        }
+        if (current == number) {
+            return slot.entry.load(std::memory_order_acquire);
+        }
+    }
+}
+
+ReadIndex::Slot* ReadIndex::Locate(Table* table, uint64_t number) {
+    for (size_t pos = Home(number, table->mask);; pos = (pos + 1) & table->mask) {
+        Slot& slot = table->slots[pos];
+        uint64_t current = slot.number.load(std::memory_order_relaxed);
+        if (current == number) {
+            return &slot;
+        }
+        if (current == 0) {
+            // 先写快照指针再写编号，读者看到编号时一定能看到快照
+            slot.entry.store(nullptr, std::memory_order_relaxed);
+            slot.number.store(number, std::memory_order_release);
+            ++table->used;
+            return &slot;
+        }
+    }
+}
+
+void ReadIndex::Publish(uint32_t recordIndex, const Entry* entry) {
+    if (recordIndex >= by_record_.size()) {
+        by_record_.resize(recordIndex + 1, nullptr);
+    }
+    const Entry* old = by_record_[recordIndex];
+    by_record_[recordIndex] = nullptr; // 换表时不再放入旧快照
+    Table* table = table_.load(std::memory_order_relaxed);
+    // 槽中仍是本记录的旧快照时才删除（同一编号可能已经由其他记录槽位重新发布）
+    if (old) {
+        Slot* slot = Locate(table, old->number);
+        if (slot->entry.load(std::memory_order_relaxed) == old) {
+            slot->entry.store(nullptr, std::memory_order_release);
+            --live_;
+        }
+    }
+    if (entry) {
+        // 墓碑和有效快照合计超过容量的 1/2 时换表（只按有效快照数量决定新容量）
+        if ((table->used + 1) * 2 > table->mask + 1) {
+            Rebuild(std::max(kMinCapacity, (live_ + 1) * 4));
+            table = table_.load(std::memory_order_relaxed);
+        }
+        Slot* slot = Locate(table, entry->number);
+        if (!slot->entry.load(std::memory_order_relaxed)) {
+            ++live_;
+        }
+        slot->entry.store(entry, std::memory_order_release);
+    }
+    by_record_[recordIndex] = entry;
+    if (old) {
+        EpochReclaimer::Instance().Retire(old);
+    }
+}
+
+void ReadIndex::Rebuild(size_t capacity) {
+    size_t rounded = kMinCapacity;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+    Table* table = new Table(rounded);
+    for (const Entry* entry : by_record_) {
+        if (entry) {
+            Locate(table, entry->number)->entry.store(entry, std::memory_order_relaxed);
+        }
+    }
+    Table* old = table_.exchange(table, std::memory_order_acq_rel);
+    EpochReclaimer::Instance().Retire(old);
+}
+
+void ReadIndex::Clear() {
+    Table* old = table_.exchange(new Table(kMinCapacity), std::memory_order_acq_rel);
+    EpochReclaimer& reclaimer = EpochReclaimer::Instance();
+    reclaimer.Retire(old);
+    for (const Entry* entry : by_record_) {
+        if (entry) {
+            reclaimer.Retire(entry);
+        }
+    }
+    by_record_.clear();
+    live_ = 0;
+}
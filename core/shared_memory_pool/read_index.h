@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 无锁读取索引：Memory ID 编号 -> 只读的记录快照
+// 只有一个写者（持有内存池写锁）；读者在 EpochReclaimer::Guard 内不加锁查找。
+// 快照创建后不再修改，替换或删除时交给 EpochReclaimer 延迟释放；
+// 哈希表只会把空槽填上编号、替换槽中的快照指针，扩容时整表替换，旧表同样延迟释放
+class ReadIndex {
+  public:
+    struct Entry {
+        uint64_t number = 0; // Memory ID 编号
+        std::string memory_id;
+        std::string description;
+        size_t start_block = 0;
+        size_t block_count = 0;
+        int slab_slot = -1;    // slab 槽位（-1 表示整块分配）
+        size_t slot_size = 0;  // slab 槽位大小
+        size_t offset = 0;     // 内容在内存池中的字节偏移
+        size_t byte_length = 0;
+        time_t last_modified = 0;
+    };
+
+    ReadIndex();
+    ~ReadIndex();
+    ReadIndex(const ReadIndex&) = delete;
+    ReadIndex& operator=(const ReadIndex&) = delete;
+
+    // 读者：查找编号对应的快照（不存在返回 nullptr），须在 EpochReclaimer::Guard 内调用
+    const Entry* Find(uint64_t number) const;
+
+    // 写者：把记录槽位 recordIndex 的快照替换为 entry（nullptr 表示记录已删除），接管 entry
+    void Publish(uint32_t recordIndex, const Entry* entry);
+    // 写者：当前发布的快照（不存在返回 nullptr）
+    const Entry* Published(uint32_t recordIndex) const {
+        return recordIndex < by_record_.size() ? by_record_[recordIndex] : nullptr;
+    }
+    size_t RecordSlots() const {
+        return by_record_.size();
+    }
+    // 写者：删除所有快照
+    void Clear();
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> number{0};          // 0 表示空槽（编号从 1 开始）
+        std::atomic<const Entry*> entry{nullptr}; // nullptr 表示已删除（墓碑）
+    };
+    struct Table {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        size_t used = 0; // 已填编号的槽位（包括墓碑），不超过容量的 1/2
+    };
+    static size_t Home(uint64_t number, size_t mask);
+    Slot* Locate(Table* table, uint64_t number); // 找到编号所在的槽位，没有时占用一个空槽
+    void Rebuild(size_t capacity);                // 只保留有效快照，换成新表
+
+    std::atomic<Table*> table_;
+    std::vector<const Entry*> by_record_; // 记录槽位 -> 当前快照（写者使用）
+    size_t live_ = 0;                     // 有效快照数量
+};
@@ -1,4 +1,7 @@
 #include "shared_memory_pool.h"
+#include "free_extent_index.h"
+#include "tlsf_index.h"
+#include "epoch_reclaimer.h"
 #include <cstring>
 #include <algorithm>
 #include <fstream>
@@ -8,208 +11,683 @@
 #include <cstdint>
 #include <cctype>
 #include <cstdlib>
-#include <new>
-#include <set>
+#include <climits>
 #include <vector>
 
+// 本线程持有读锁的内存池（读锁嵌套时不重复加锁，避免写者排队时自身阻塞）
+static thread_local std::vector<const SharedMemoryPool*> t_read_locked_pools;
+
+// 线程编号（选择区间缓存），线程第一次使用缓存时分配
+static std::atomic<size_t> g_next_thread_number{0};
+static thread_local size_t t_thread_number = g_next_thread_number.fetch_add(1);
+
+// 无锁读取时复制内存池内容。写者可能正在用 memcpy 修改同一段内存（有意接受的竞争）：
+// 读到的数据在写序号变化时整体丢弃，这里只保证复制本身不会被编译器按普通内存访问优化
+// （逐字 relaxed 原子读取，MSVC 用 volatile 读取），并对 ThreadSanitizer 关闭检查
+#if defined(_MSC_VER)
+static void CopyRacyBytes(void* dst, const uint8_t* src, size_t length) {
+    const volatile uint8_t* from = src;
+    uint8_t* to = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < length; ++i) {
+        to[i] = from[i];
+    }
+}
+#else
+__attribute__((no_sanitize_thread))
+static void CopyRacyBytes(void* dst, const uint8_t* src, size_t length) {
+    uint8_t* to = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+    for (; i < length && (reinterpret_cast<uintptr_t>(src + i) & 7) != 0; ++i) {
+        to[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    }
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word = __atomic_load_n(reinterpret_cast<const uint64_t*>(src + i),
+                                        __ATOMIC_RELAXED);
+        std::memcpy(to + i, &word, sizeof(word));
+    }
+    for (; i < length; ++i) {
+        to[i] = __atomic_load_n(src + i, __ATOMIC_RELAXED);
+    }
+}
+#endif
+
+// 初始化（默认大小）
+bool SharedMemoryPool::Init(AllocationPolicy policy) {
+    return Init(kDefaultPoolSize, kDefaultBlockSize, policy);
+}
+
 // 初始化
-bool SharedMemoryPool::Init() {
-    // 如果已经初始化过，先释放旧内存
+bool SharedMemoryPool::Init(size_t poolSize, size_t blockSize, AllocationPolicy policy) {
+    if (HasExternalReferences()) {
+        return false; // 重新映射会让视图和预留指向已解除映射的内存
+    }
+    // 块大小须为 2 的幂（slab 槽位按块大小的 1/64 - 1/2 切分）
+    if (blockSize < kMinBlockSize || (blockSize & (blockSize - 1)) != 0) {
+        return false;
+    }
+    size_t blockCount = poolSize / blockSize;
+    // 块号以 int 返回（AllocateBlock），块数量不能超过 INT_MAX
+    if (blockCount == 0 || blockCount > static_cast<size_t>(INT_MAX)) {
+        return false;
+    }
+
+    // 如果已经初始化过，先释放旧内存（共享段由 segment_ 负责解除映射）
+    // 无锁读者可能还在按旧快照从旧映射复制，等它们离开后再解除映射；
+    // 调用方持有写锁，之后进入的读者看到奇数写序号，不会读取 pool_
+    if (read_index_) {
+        EpochReclaimer::Instance().Synchronize();
+    }
     if (pool_) {
-        std::free(pool_);
+        PageMemory::Unmap(pool_, pool_size_, backing_);
         pool_ = nullptr;
     }
-    if (meta_) {
-        // 调用每个 BlockMeta 的析构函数
-        for (size_t i = 0; i < kBlockCount; ++i) {
-            meta_[i].~BlockMeta();
-        }
-        std::free(meta_);
-        meta_ = nullptr;
-    }
+    segment_.reset();
+    block_count_ = 0;
+    pool_size_ = 0;
 
-    // 使用 malloc 分配内存池数据
-    pool_ = static_cast<uint8_t*>(std::malloc(kPoolSize));
+    // 按页映射内存池数据（映射得到的是零页，不需要再清零）
+    void* addr = PageMemory::Map(blockCount * blockSize, huge_pages_, &backing_, numa_node_);
+    pool_ = static_cast<uint8_t*>(addr);
     if (!pool_) {
         return false; // 内存分配失败
     }
 
-    // 使用 malloc 分配元信息数组
-    meta_ = static_cast<BlockMeta*>(std::malloc(sizeof(BlockMeta) * kBlockCount));
-    if (!meta_) {
-        std::free(pool_);
-        pool_ = nullptr;
-        return false; // 内存分配失败
+    SetupMetadata(blockCount, blockSize, policy);
+
+    // 初始化元数据（内存池数据已经是零页），旧快照在 ResetMetadata 中删除，解锁时重新发布
+    ResetMetadata();
+    publish_all_ = true;
+    return true;
+}
+
+// 打开（或创建）跨进程共享段
+bool SharedMemoryPool::InitShared(const std::string& name, size_t poolSize, size_t blockSize,
+                                  AllocationPolicy policy, size_t recordCapacity) {
+    if (HasExternalReferences()) {
+        return false;
+    }
+    if (blockSize < kMinBlockSize || (blockSize & (blockSize - 1)) != 0) {
+        return false;
+    }
+    size_t blockCount = poolSize / blockSize;
+    if (blockCount == 0 || blockCount > static_cast<size_t>(INT_MAX)) {
+        return false;
     }
 
-    // 使用 placement new 初始化每个 BlockMeta 对象（调用构造函数）
-    for (size_t i = 0; i < kBlockCount; ++i) {
-        new (meta_ + i) BlockMeta();
+    auto segment = std::make_unique<SharedSegment>();
+    bool created = false;
+    if (!segment->Open(name, blockCount * blockSize, blockSize,
+                       recordCapacity ? recordCapacity : blockCount, created)) {
+        return false;
     }
+    // 段已存在时使用段中的规格
+    const SharedSegment::Header* header = segment->GetHeader();
+    blockSize = static_cast<size_t>(header->block_size);
+    blockCount = static_cast<size_t>(header->pool_size) / blockSize;
 
-    // 初始化内存
-    Reset();
+    if (read_index_) {
+        EpochReclaimer::Instance().Synchronize();
+    }
+    if (pool_) {
+        PageMemory::Unmap(pool_, pool_size_, backing_);
+        pool_ = nullptr;
+    }
+    segment_ = std::move(segment);
+    pool_ = segment_->GetPoolData();
+    backing_ = PageMemory::Backing::kShared;
+    SetupMetadata(blockCount, blockSize, policy);
+    ResetMetadata();
+
+    // 从段内记录表建立本地索引
+    segment_generation_ = 0;
+    SharedLock lock(*this);
     return true;
 }
 
+// 按内存池规格设置元数据
+void SharedMemoryPool::SetupMetadata(size_t blockCount, size_t blockSize,
+                                     AllocationPolicy policy) {
+    // 记录内存池规格，位图、块归属数组和 slab 槽位大小随之调整
+    block_size_ = blockSize;
+    block_count_ = blockCount;
+    pool_size_ = blockCount * blockSize;
+    used_map.Resize(block_count_);
+    used_map.EnableRunStats();
+    resident_map_.Resize(block_count_);
+    block_owner_.assign(block_count_, kNoOwner);
+    slab_allocator_ = SlabAllocator(block_size_);
+    run_caches_.assign(kRunCacheCount, BlockRunCache());
+    cached_blocks_ = 0;
+
+    // 根据分配策略创建空闲块索引
+    policy_ = policy;
+    switch (policy_) {
+    case AllocationPolicy::kBestFit:
+        free_index_ = std::make_unique<FreeExtentIndex>();
+        break;
+    case AllocationPolicy::kTlsf:
+        free_index_ = std::make_unique<TlsfIndex>();
+        break;
+    case AllocationPolicy::kNextFit:
+    default:
+        free_index_.reset();
+        break;
+    }
+}
+
 // 重置
-void SharedMemoryPool::Reset() {
-    if (pool_) {
-        std::memset(pool_, 0, kPoolSize);
+bool SharedMemoryPool::Reset() {
+    if (HasExternalReferences()) {
+        return false; // 归还物理页后视图持有者会读到 0，预留的区间会被重新分配
+    }
+    // 归还物理页，之后读取为 0（失败时退回逐字节清零）
+    if (read_index_) {
+        EpochReclaimer::Instance().Synchronize();
+    }
+    if (pool_ && !PageMemory::Discard(pool_, pool_size_, backing_)) {
+        std::memset(pool_, 0, pool_size_);
+    }
+    ResetMetadata();
+    publish_all_ = true; // 共享段：发布清空后的记录表
+    return true;
+}
+
+void SharedMemoryPool::ResetMetadata() {
+    free_block_count = block_count_;
+    used_map.Reset();
+    resident_map_.Reset();
+    if (free_index_) {
+        free_index_->Reset(block_count_);
+    }
+    std::fill(block_owner_.begin(), block_owner_.end(), kNoOwner);
+    records_.clear();
+    free_records_.clear();
+    memory_index_.Clear();
+    if (read_index_) {
+        read_index_->Clear();
+    }
+    slab_allocator_.Clear();
+    slab_slot_owner_.clear();
+    for (BlockRunCache& cache : run_caches_) {
+        cache.Clear();
+    }
+    cached_blocks_ = 0;
+    {
+        // Init / Reset 在有视图时不会执行到这里，共享段同步时不支持视图，这里只是保持一致
+        std::lock_guard<std::mutex> lock(view_mutex_);
+        view_leases_.clear();
+        record_views_.clear();
+        unit_views_.clear();
+        active_views_.store(0, std::memory_order_release);
+    }
+    reservations_.clear(); // 同上：有未提交的预留时不会执行到这里
+    reserved_starts_.clear();
+    compact_cursor_ = 0;
+    next_memory_id_counter_ = memory_id_first_; // 重置计数器
+    next_search_pos_ = 0;        // 重置搜索起始位置
+    dirty_records_.clear();
+}
+
+// 操作锁：共享段内存池加锁后同步其他进程的修改
+SharedMemoryPool::SharedLock::SharedLock(SharedMemoryPool& pool, Mode mode) : pool_(pool) {
+    // 本线程已经持有写锁（嵌套调用）
+    if (pool_.lock_owner_.load() == std::this_thread::get_id()) {
+        return;
     }
-    free_block_count = kBlockCount;
-    for (size_t i = 0; i < kBlockCount; i++) {
-        used_map.set(i, false);
+    // 读锁：普通内存池的只读操作可以并行
+    if (mode == Mode::kRead && !pool_.segment_) {
+        auto& held = t_read_locked_pools;
+        if (std::find(held.begin(), held.end(), &pool_) != held.end()) {
+            return;
+        }
+        // 有写者在等待时先让写者完成
+        pool_.write_gate_.lock();
+        pool_.write_gate_.unlock();
+        pool_.op_mutex_.lock_shared();
+        held.push_back(&pool_);
+        read_locked_ = true;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> gate(pool_.write_gate_);
+        pool_.op_mutex_.lock();
     }
-    if (meta_) {
-        for (size_t i = 0; i < kBlockCount; i++) {
-            meta_[i] = BlockMeta{};
+    pool_.lock_owner_.store(std::this_thread::get_id());
+    locked_ = true;
+    // 写序号变为奇数，之后对内存池的修改都会使正在进行的无锁读取重试
+    pool_.write_seq_.store(pool_.write_seq_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (!pool_.segment_) {
+        return;
+    }
+    segment_ = pool_.segment_.get();
+    bool ownerDied = segment_->Lock();
+
+    const SharedSegment::Header* header = segment_->GetHeader();
+    if (ownerDied || header->generation != pool_.segment_generation_) {
+        // 通常只按变更日志更新其他进程改动过的记录，代价与改动的记录数成正比
+        if (ownerDied || !pool_.ApplySegmentJournal()) {
+            pool_.SyncFromSegment();
+        }
+        // 上一个持有者异常退出，记录表可能只写了一部分，按重建后的状态重新发布
+        if (ownerDied) {
+            pool_.publish_all_ = true;
         }
     }
-    memory_info.clear();
-    memory_last_modified_time.clear(); // Clear last modified times
-    next_memory_id_counter_ = 1;       // 重置计数器
-    next_search_pos_ = 0;              // 重置搜索起始位置
+    pool_.next_memory_id_counter_ = header->next_memory_id;
+    pool_.next_search_pos_ = static_cast<size_t>(header->next_search_pos);
 }
 
-// 设置元数据
-bool SharedMemoryPool::SetMeta(size_t blockId, const std::string& memory_id,
-                               const std::string& description) {
-    if (used_map[blockId])
-        return false;
-    auto& m = meta_[blockId];
-    m.used = true;
-    m.memory_id = memory_id;
-    m.description = description;
-    free_block_count--;
-    used_map.set(blockId, true);
-    return true;
+// 操作锁：共享段内存池发布本进程的修改后解锁
+SharedMemoryPool::SharedLock::~SharedLock() {
+    if (read_locked_) {
+        auto& held = t_read_locked_pools;
+        held.erase(std::find(held.begin(), held.end(), &pool_));
+        pool_.op_mutex_.unlock_shared();
+        return;
+    }
+    if (!locked_) {
+        return;
+    }
+    if (segment_ && segment_ == pool_.segment_.get()) {
+        pool_.PublishToSegment();
+        segment_->Unlock();
+    }
+    if (pool_.read_index_) {
+        pool_.PublishReadIndex();
+    }
+    pool_.write_seq_.store(pool_.write_seq_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_release);
+    pool_.lock_owner_.store(std::thread::id());
+    pool_.op_mutex_.unlock();
+}
+
+// 启动后台紧凑线程
+void SharedMemoryPool::StartBackgroundCompaction(const BackgroundCompactor::Settings& settings) {
+    if (!compactor_) {
+        compactor_ = std::make_unique<BackgroundCompactor>(*this);
+    }
+    compactor_->Start(settings);
 }
 
-// 设置元数据（加载时使用）
-void SharedMemoryPool::SetMetaForLoad(size_t blockId, const std::string& memory_id,
-                                      const std::string& description) {
-    auto& m = meta_[blockId];
-    m.used = true;
-    m.memory_id = memory_id;
-    m.description = description;
-    // 不修改 free_block_count 和 used_map，因为这些已经在加载时设置好了
+// 停止后台紧凑线程
+void SharedMemoryPool::StopBackgroundCompaction() {
+    if (compactor_) {
+        compactor_->Stop();
+        compactor_.reset();
+    }
+}
+
+// 共享段的记录表是否还有空位
+bool SharedMemoryPool::HasRecordCapacity() const {
+    return !segment_ || !free_records_.empty() ||
+           records_.size() < segment_->GetHeader()->record_capacity;
 }
 
-// 获取内存块信息
-const std::map<std::string, std::pair<size_t, size_t>>& SharedMemoryPool::GetMemoryInfo() const {
-    return memory_info;
+// 从段内记录表重建本地索引（分配记录、块归属、位图、空闲索引和 slab）
+void SharedMemoryPool::SyncFromSegment() {
+    ResetMetadata();
+    const SharedSegment::Header* header = segment_->GetHeader();
+    const SharedSegment::RecordEntry* entries = segment_->GetRecords();
+    size_t count = static_cast<size_t>(std::min(header->record_count, header->record_capacity));
+
+    records_.resize(count);
+    std::map<size_t, std::pair<int, uint64_t>> slabs; // slab 块 -> (级别, 槽位占用位图)
+    for (size_t i = 0; i < count; ++i) {
+        const SharedSegment::RecordEntry& entry = entries[i];
+        std::string memoryId(entry.memory_id, strnlen(entry.memory_id, SharedSegment::kIdSize));
+        size_t start = static_cast<size_t>(entry.start_block);
+        size_t blockCount = static_cast<size_t>(entry.block_count);
+        bool valid = !memoryId.empty() && !memory_index_.Contains(memoryId) && blockCount > 0 &&
+                     start < block_count_ && blockCount <= block_count_ - start;
+        if (!valid) {
+            free_records_.push_back(static_cast<uint32_t>(i));
+            continue;
+        }
+
+        uint32_t index = static_cast<uint32_t>(i);
+        AllocationRecord& record = records_[i];
+        record.memory_id = memoryId;
+        record.description.assign(entry.description,
+                                  strnlen(entry.description, SharedSegment::kDescSize));
+        record.start_block = start;
+        record.block_count = blockCount;
+        record.byte_length = static_cast<size_t>(entry.byte_length);
+        record.last_modified = static_cast<time_t>(entry.last_modified);
+        record.slab_slot = entry.slab_slot;
+        memory_index_.Insert(memoryId, index);
+
+        if (record.slab_slot >= 0) {
+            auto& slab = slabs[start];
+            slab.first = entry.slab_class;
+            slab.second |= 1ULL << (record.slab_slot & 63);
+            slab_slot_owner_[SlabSlotKey(start, record.slab_slot & 63)] = index;
+            continue;
+        }
+        std::fill(block_owner_.begin() + start, block_owner_.begin() + start + blockCount, index);
+        MarkBlocksUsed(start, blockCount);
+        free_block_count -= blockCount;
+    }
+    for (const auto& entry : slabs) {
+        RestoreSlab(entry.first, entry.second.first, entry.second.second);
+    }
+    segment_generation_ = header->generation;
+    segment_journal_pos_ = header->journal_end;
 }
 
-// 更新内存块数量
-void SharedMemoryPool::UpdateMemoryBlockCount(const std::string& memory_id, size_t newBlockCount) {
-    auto it = memory_info.find(memory_id);
-    if (it != memory_info.end()) {
-        size_t oldBlockCount = it->second.second;
-        it->second.second = newBlockCount;
-        // 更新空闲块计数
-        if (newBlockCount < oldBlockCount) {
-            free_block_count += (oldBlockCount - newBlockCount);
-        } else if (newBlockCount > oldBlockCount) {
-            free_block_count -= (newBlockCount - oldBlockCount);
+// 按变更日志更新改动过的记录：先移除这些记录在本地的旧位置，再按段内条目放到新位置
+// （段内的最终状态互不重叠，全部移除后再放入不会与未改动的记录冲突）
+bool SharedMemoryPool::ApplySegmentJournal() {
+    const SharedSegment::Header* header = segment_->GetHeader();
+    const size_t count = static_cast<size_t>(header->record_count);
+    if (segment_generation_ < header->resync_generation ||
+        header->journal_end < segment_journal_pos_ ||
+        header->journal_end - segment_journal_pos_ > SharedSegment::kJournalSize ||
+        count > header->record_capacity || count < records_.size()) {
+        return false;
+    }
+    std::vector<uint32_t> changed;
+    for (uint64_t pos = segment_journal_pos_; pos < header->journal_end; ++pos) {
+        changed.push_back(header->journal[pos % SharedSegment::kJournalSize]);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    // 新增的下标都在日志中
+    const size_t oldCount = records_.size();
+    size_t added = changed.end() - std::lower_bound(changed.begin(), changed.end(), oldCount);
+    if ((!changed.empty() && changed.back() >= count) || added != count - oldCount) {
+        return false;
+    }
+
+    // 移除旧位置
+    std::vector<bool> wasUsed(changed.size(), false);
+    for (size_t i = 0; i < changed.size(); ++i) {
+        uint32_t index = changed[i];
+        if (index >= oldCount || records_[index].memory_id.empty()) {
+            continue;
+        }
+        wasUsed[i] = true;
+        AllocationRecord& record = records_[index];
+        size_t start = record.start_block;
+        memory_index_.Erase(record.memory_id);
+        if (record.slab_slot >= 0) {
+            slab_slot_owner_.erase(SlabSlotKey(start, record.slab_slot));
+            if (slab_allocator_.FreeSlot(start, static_cast<size_t>(record.slab_slot))) {
+                block_owner_[start] = kNoOwner;
+                MarkBlocksFree(start, 1);
+                free_block_count++;
+            }
+        } else {
+            std::fill(block_owner_.begin() + start,
+                      block_owner_.begin() + start + record.block_count, kNoOwner);
+            MarkBlocksFree(start, record.block_count);
+            free_block_count += record.block_count;
+        }
+        record = AllocationRecord{};
+    }
+
+    // 放到新位置（与本地状态冲突时放弃，调用方完整重建）
+    records_.resize(count);
+    const SharedSegment::RecordEntry* entries = segment_->GetRecords();
+    for (size_t i = 0; i < changed.size(); ++i) {
+        uint32_t index = changed[i];
+        const SharedSegment::RecordEntry& entry = entries[index];
+        std::string memoryId(entry.memory_id, strnlen(entry.memory_id, SharedSegment::kIdSize));
+        if (memoryId.empty()) {
+            if (wasUsed[i] || index >= oldCount) {
+                free_records_.push_back(index);
+            }
+            continue;
+        }
+        size_t start = static_cast<size_t>(entry.start_block);
+        size_t blockCount = static_cast<size_t>(entry.block_count);
+        if (memory_index_.Contains(memoryId) || blockCount == 0 || start >= block_count_ ||
+            blockCount > block_count_ - start) {
+            return false;
+        }
+        if (entry.slab_slot >= 0) {
+            int sizeClass = entry.slab_class;
+            size_t slot = static_cast<size_t>(entry.slab_slot);
+            if (sizeClass < 0 || sizeClass >= static_cast<int>(SlabAllocator::kClassCount) ||
+                slot >= slab_allocator_.SlotsPerSlab(sizeClass)) {
+                return false;
+            }
+            if (slab_allocator_.IsSlab(start)) {
+                if (slab_allocator_.GetSizeClass(start) != sizeClass ||
+                    slab_allocator_.IsSlotUsed(start, slot)) {
+                    return false;
+                }
+                slab_allocator_.MarkSlotUsed(start, slot);
+            } else if (!RestoreSlab(start, sizeClass, 1ULL << slot)) {
+                return false; // 块已被其他单元占用
+            }
+            slab_slot_owner_[SlabSlotKey(start, slot)] = index;
+        } else {
+            if (used_map.FindNextUsed(start) < start + blockCount) {
+                return false;
+            }
+            std::fill(block_owner_.begin() + start, block_owner_.begin() + start + blockCount,
+                      index);
+            MarkBlocksUsed(start, blockCount);
+            free_block_count -= blockCount;
+        }
+        AllocationRecord& record = records_[index];
+        record.memory_id = memoryId;
+        record.description.assign(entry.description,
+                                  strnlen(entry.description, SharedSegment::kDescSize));
+        record.start_block = start;
+        record.block_count = blockCount;
+        record.byte_length = static_cast<size_t>(entry.byte_length);
+        record.last_modified = static_cast<time_t>(entry.last_modified);
+        record.slab_slot = entry.slab_slot;
+        memory_index_.Insert(memoryId, index);
+        // 本地原来空闲的槽位被其他进程使用（通常是最近释放的，从末尾查找）
+        if (!wasUsed[i] && index < oldCount) {
+            auto it = std::find(free_records_.rbegin(), free_records_.rend(), index);
+            if (it != free_records_.rend()) {
+                free_records_.erase(std::next(it).base());
+            }
         }
-        // 更新最后修改时间
-        memory_last_modified_time[memory_id] = std::time(nullptr);
     }
+    segment_generation_ = header->generation;
+    segment_journal_pos_ = header->journal_end;
+    return true;
 }
 
-// Base62 编码：将数字转换为 Base62 字符串（0-9, a-z, A-Z）
-std::string SharedMemoryPool::EncodeBase62(uint64_t num, size_t minLength) {
-    const char* base62_chars = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    std::string result;
+// 发布本进程的修改（只写入改动过的记录槽位）
+void SharedMemoryPool::PublishToSegment() {
+    SharedSegment::Header* header = segment_->GetHeader();
+    header->next_memory_id = next_memory_id_counter_;
+    header->next_search_pos = next_search_pos_;
+    if (!publish_all_ && dirty_records_.empty()) {
+        return;
+    }
 
-    if (num == 0) {
-        result = "0";
+    SharedSegment::RecordEntry* entries = segment_->GetRecords();
+    auto writeEntry = [this, entries](size_t index) {
+        if (index >= records_.size()) {
+            return;
+        }
+        AllocationRecord& record = records_[index];
+        // 描述按条目长度截断，本地记录保持一致
+        record.description = SharedSegment::FitDescription(record.description);
+        SharedSegment::RecordEntry& entry = entries[index];
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.memory_id, record.memory_id.data(),
+                    std::min(record.memory_id.size(), SharedSegment::kIdSize - 1));
+        std::memcpy(entry.description, record.description.data(), record.description.size());
+        entry.start_block = record.start_block;
+        entry.block_count = record.block_count;
+        entry.byte_length = record.byte_length;
+        entry.last_modified = static_cast<int64_t>(record.last_modified);
+        entry.slab_slot = record.slab_slot;
+        entry.slab_class =
+            (record.slab_slot >= 0) ? slab_allocator_.GetSizeClass(record.start_block) : -1;
+    };
+    if (publish_all_) {
+        for (size_t i = 0; i < records_.size(); ++i) {
+            writeEntry(i);
+        }
     } else {
-        while (num > 0) {
-            result = base62_chars[num % 62] + result;
-            num /= 62;
+        for (uint32_t index : dirty_records_) {
+            writeEntry(index);
         }
     }
+    header->record_count = records_.size();
+    header->generation++;
+    // 改动的下标写入变更日志；全部发布或改动超过日志容量时其他进程完整重建
+    if (publish_all_ || dirty_records_.size() > SharedSegment::kJournalSize) {
+        header->resync_generation = header->generation;
+    } else {
+        for (uint32_t index : dirty_records_) {
+            header->journal[header->journal_end % SharedSegment::kJournalSize] = index;
+            header->journal_end++;
+        }
+    }
+    segment_generation_ = header->generation;
+    segment_journal_pos_ = header->journal_end;
+    dirty_records_.clear();
+    publish_all_ = false;
+}
 
-    // 填充到最小长度（左侧补0）
-    while (result.length() < minLength) {
-        result = "0" + result;
+// 分配一个记录槽位（优先复用已释放的槽位）
+uint32_t SharedMemoryPool::NewRecord(const std::string& memory_id) {
+    uint32_t index;
+    if (!free_records_.empty()) {
+        index = free_records_.back();
+        free_records_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(records_.size());
+        records_.emplace_back();
     }
+    records_[index].memory_id = memory_id;
+    memory_index_.Insert(memory_id, index);
+    MarkRecordDirty(index);
+    return index;
+}
+
+// 回收记录槽位
+void SharedMemoryPool::ReleaseRecord(uint32_t index) {
+    memory_index_.Erase(records_[index].memory_id);
+    records_[index] = AllocationRecord{};
+    free_records_.push_back(index);
+    MarkRecordDirty(index);
+}
 
+// 查找分配记录
+const SharedMemoryPool::AllocationRecord*
+SharedMemoryPool::FindMemory(const std::string& memory_id) const {
+    uint32_t index = memory_index_.Find(memory_id);
+    return index == MemoryIdIndex::npos ? nullptr : &records_[index];
+}
+
+// 获取按起始块排序的所有分配记录
+std::vector<const SharedMemoryPool::AllocationRecord*>
+SharedMemoryPool::GetAllocationsByStart() const {
+    std::vector<const AllocationRecord*> result;
+    result.reserve(memory_index_.Size());
+    for (const AllocationRecord& record : records_) {
+        if (!record.memory_id.empty()) {
+            result.push_back(&record);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(), [](const auto* a, const auto* b) {
+        return a->start_block < b->start_block;
+    });
     return result;
 }
 
-// Base62 解码：将 Base62 字符串转换为数字
-uint64_t SharedMemoryPool::DecodeBase62(const std::string& str) {
-    uint64_t result = 0;
-    uint64_t base = 1;
+// 获取内存描述
+std::string SharedMemoryPool::GetMemoryDescription(const std::string& memory_id) const {
+    const AllocationRecord* record = FindMemory(memory_id);
+    return record ? record->description : "";
+}
 
-    for (int i = static_cast<int>(str.length()) - 1; i >= 0; i--) {
-        char c = str[i];
-        uint64_t value = 0;
+// 查询 slab 小对象所在槽位
+bool SharedMemoryPool::GetSlabSlot(const std::string& memory_id, size_t& slot,
+                                   size_t& slotSize) const {
+    const AllocationRecord* record = FindMemory(memory_id);
+    if (!record || record->slab_slot < 0) {
+        return false;
+    }
+    slot = static_cast<size_t>(record->slab_slot);
+    slotSize = slab_allocator_.SlotSize(slab_allocator_.GetSizeClass(record->start_block));
+    return true;
+}
 
-        if (c >= '0' && c <= '9') {
-            value = c - '0';
-        } else if (c >= 'a' && c <= 'z') {
-            value = 10 + (c - 'a');
-        } else if (c >= 'A' && c <= 'Z') {
-            value = 36 + (c - 'A');
-        } else {
-            return 0; // 无效字符
-        }
+// 原地更新后调整分配大小（释放尾部多余的块）
+void SharedMemoryPool::UpdateMemorySize(const std::string& memory_id, size_t newBlockCount,
+                                        size_t byteLength) {
+    uint32_t index = memory_index_.Find(memory_id);
+    if (index == MemoryIdIndex::npos) {
+        return;
+    }
+    AllocationRecord& record = records_[index];
+    if (record.slab_slot < 0 && !IsRecordPinned(index)) {
+        ShrinkRecord(index, newBlockCount);
+    }
+    record.byte_length = byteLength;
+    record.last_modified = std::time(nullptr);
+    MarkRecordDirty(index);
+}
 
-        result += value * base;
-        base *= 62;
+// 缩小分配，释放尾部多余的块
+void SharedMemoryPool::ShrinkRecord(uint32_t index, size_t newBlockCount) {
+    AllocationRecord& record = records_[index];
+    if (newBlockCount == 0 || newBlockCount >= record.block_count) {
+        return;
+    }
+    size_t tailStart = record.start_block + newBlockCount;
+    size_t tailCount = record.block_count - newBlockCount;
+    std::fill(block_owner_.begin() + tailStart, block_owner_.begin() + tailStart + tailCount,
+              kNoOwner);
+    MarkBlocksFree(tailStart, tailCount);
+    MaybeReleaseBlocks(tailStart, tailCount);
+    free_block_count += tailCount;
+    record.block_count = newBlockCount;
+    if (tailStart < next_search_pos_) {
+        next_search_pos_ = tailStart;
     }
+}
 
-    return result;
+// 更新指定内存ID的最后修改时间
+void SharedMemoryPool::UpdateMemoryLastModifiedTime(const std::string& memory_id) {
+    uint32_t index = memory_index_.Find(memory_id);
+    if (index != MemoryIdIndex::npos) {
+        records_[index].last_modified = std::time(nullptr);
+        MarkRecordDirty(index);
+    }
 }
 
 // 生成下一个可用的 memory_id（O(1) 时间复杂度）
 std::string SharedMemoryPool::GenerateNextMemoryId() const {
-    uint64_t currentId = next_memory_id_counter_++;
-
     // 使用 Base62 编码，自动扩展位数：
     // 5位：支持约9亿个ID（0 - 916,132,831）
     // 6位：支持约568亿个ID（916,132,832 - 56,800,235,583）
     // 7位：支持约3521亿个ID（56,800,235,584 - 3,521,614,606,207）
-    size_t minLength = 5;
-    if (currentId >= 916132832ULL) { // 62^5 = 916,132,832
-        minLength = 6;
-    }
-    if (currentId >= 56800235584ULL) { // 62^6 = 56,800,235,584
-        minLength = 7;
-    }
-
-    std::string encoded = EncodeBase62(currentId, minLength);
-    return "memory_" + encoded;
+    uint64_t number = next_memory_id_counter_.fetch_add(memory_id_stride_);
+    return MemoryIdIndex::FormatId(number);
 }
 
-// 初始化 Memory ID 计数器（从已存在的 memory_info 中找出最大值）
+// 初始化 Memory ID 计数器（从已存在的分配记录中找出最大值）
 // 在从文件加载后调用，确保计数器大于所有已存在的 ID
-// 仅支持 Base62 编码格式
+// 只统计标准格式的 ID（其他格式的 ID 不会与生成的 ID 重复）
 void SharedMemoryPool::InitializeMemoryIdCounter() {
-    uint64_t maxId = 0;
-
-    for (const auto& entry : memory_info) {
-        const std::string& id = entry.first;
-        if (id.length() > 7 && id.substr(0, 7) == "memory_") {
-            std::string suffix = id.substr(7);
-            uint64_t currentId = DecodeBase62(suffix);
-
-            if (currentId > 0 || suffix == "0") {
-                maxId = std::max(maxId, currentId);
-            }
-        }
+    // 设置为编号序列中大于最大值的第一个编号
+    uint64_t maxId = memory_index_.MaxNumber();
+    next_memory_id_counter_ = memory_id_first_;
+    if (maxId >= memory_id_first_) {
+        next_memory_id_counter_ += ((maxId - memory_id_first_) / memory_id_stride_ + 1) *
+                                   memory_id_stride_;
     }
-
-    next_memory_id_counter_ = maxId + 1; // 设置为下一个可用的 ID
 }
 
-// 获取块元数据
-const SharedMemoryPool::BlockMeta& SharedMemoryPool::GetMeta(size_t blockId) const {
-    return meta_[blockId];
+// 设置 Memory ID 编号序列
+void SharedMemoryPool::SetMemoryIdSequence(uint64_t first, uint64_t stride) {
+    memory_id_first_ = std::max<uint64_t>(first, 1);
+    memory_id_stride_ = std::max<uint64_t>(stride, 1);
+    InitializeMemoryIdCounter();
 }
 
 // 查找连续的空闲块
@@ -217,99 +695,626 @@ int SharedMemoryPool::FindContinuousFreeBlock(size_t blockCount) {
     if (blockCount > free_block_count)
         return -1;
 
-    // 从 next_search_pos_ 开始搜索（Next Fit 优化）
-    for (size_t i = next_search_pos_; i < kBlockCount; i++) {
-        if (used_map[i])
-            continue;
-        size_t j = i;
-        while (j < kBlockCount && !used_map[j]) {
-            ++j;
+    // 从 next_search_pos_ 开始搜索（Next Fit 优化），位图按字跳过已满区域
+    size_t start = used_map.FindFreeRun(blockCount, next_search_pos_);
+    if (start == FreeSpaceBitmap::npos)
+        return -1;
+    next_search_pos_ = start + blockCount; // 更新搜索起始位置为分配结束位置
+    return static_cast<int>(start);
+}
+
+// 按当前分配策略查找连续的空闲块
+int SharedMemoryPool::FindFreeBlock(size_t blockCount) {
+    if (!free_index_)
+        return FindContinuousFreeBlock(blockCount);
+    if (blockCount > free_block_count)
+        return -1;
+    size_t start = free_index_->Find(blockCount);
+    if (start == FreeBlockIndex::npos)
+        return -1;
+    return static_cast<int>(start);
+}
+
+// 获取分配策略名称
+const char* SharedMemoryPool::GetAllocationPolicyName(AllocationPolicy policy) {
+    switch (policy) {
+    case AllocationPolicy::kNextFit:
+        return "Next Fit";
+    case AllocationPolicy::kBestFit:
+        return "Best Fit";
+    case AllocationPolicy::kTlsf:
+        return "TLSF";
+    default:
+        return "Unknown";
+    }
+}
+
+// 标记块区间为已使用
+void SharedMemoryPool::MarkBlocksUsed(size_t start, size_t count) {
+    if (free_index_) {
+        free_index_->Remove(FreeRunHead(start), start, count);
+    }
+    used_map.SetRange(start, count, true);
+    resident_map_.SetRange(start, count, true); // 已使用的块都会被写入
+}
+
+// 空闲块所在空闲区间的首块（分配路径上 start 就是首块，只检查前一块）
+size_t SharedMemoryPool::FreeRunHead(size_t start) const {
+    if (start == 0 || used_map.Test(start - 1)) {
+        return start;
+    }
+    size_t prev = used_map.FindPrevUsed(start - 1);
+    return (prev == FreeSpaceBitmap::npos) ? 0 : prev + 1;
+}
+
+// 标记块区间为空闲（与相邻空闲区间合并）
+void SharedMemoryPool::MarkBlocksFree(size_t start, size_t count) {
+    used_map.SetRange(start, count, false);
+    if (free_index_) {
+        free_index_->Insert(start, count);
+    }
+}
+
+// 归还块区间内整页的物理内存（块小于页时只归还完全落在区间内的页）
+size_t SharedMemoryPool::ReleaseBlocks(size_t start, size_t count) {
+    // 大页按整个大页归还，避免把透明大页拆成普通页
+    const size_t pageSize = (backing_ == PageMemory::Backing::kStandard)
+                                ? PageMemory::PageSize()
+                                : PageMemory::HugePageSize();
+    size_t begin = (start * block_size_ + pageSize - 1) / pageSize * pageSize;
+    size_t end = (start + count) * block_size_;
+    // 内存池结尾之后的部分也属于映射区间，最后一页可以整页归还
+    end = (start + count == block_count_) ? (end + pageSize - 1) / pageSize * pageSize
+                                          : end / pageSize * pageSize;
+    if (end <= begin) {
+        return 0;
+    }
+    size_t firstBlock = begin / block_size_;
+    size_t blockCount = std::min(end / block_size_, block_count_) - firstBlock;
+    size_t released = resident_map_.CountUsed(firstBlock, blockCount);
+    if (released == 0) {
+        return 0;
+    }
+    // 无锁读者可能还在按旧快照读取这段区间，等它们离开后再归还（Windows 取消提交期间不能访问）
+    if (read_index_) {
+        EpochReclaimer::Instance().Synchronize();
+    }
+    if (!PageMemory::Discard(pool_ + begin, end - begin, backing_)) {
+        return 0;
+    }
+    resident_map_.SetRange(firstBlock, blockCount, false);
+    return released;
+}
+
+// 按阈值归还释放的块区间
+void SharedMemoryPool::MaybeReleaseBlocks(size_t start, size_t count) {
+    if (release_threshold_ > 0 && count * block_size_ >= release_threshold_) {
+        ReleaseBlocks(start, count);
+    }
+}
+
+// 按常驻部分的大小决定是否归还物理页
+bool SharedMemoryPool::ShouldReleaseResident(size_t start, size_t count) const {
+    return release_threshold_ > 0 &&
+           resident_map_.CountUsed(start, count) * block_size_ >= release_threshold_;
+}
+
+// 归还所有空闲块的物理页
+size_t SharedMemoryPool::ReleaseFreeMemory() {
+    FlushRunCaches();
+    size_t released = 0;
+    size_t pos = 0;
+    while (pos < block_count_) {
+        size_t start = used_map.FindFreeRun(1, pos);
+        if (start == FreeSpaceBitmap::npos) {
+            break;
         }
-        if (j - i >= blockCount) {
-            next_search_pos_ = i + blockCount; // 更新搜索起始位置为分配结束位置
-            return i;
+        size_t end = used_map.FindNextUsed(start);
+        released += ReleaseBlocks(start, end - start);
+        pos = end;
+    }
+    return released * block_size_;
+}
+
+// 按节点统计常驻字节数（单节点时不查询页面）
+std::vector<size_t> SharedMemoryPool::GetResidentBytesByNode() const {
+    if (pool_ && NumaTopology::NodeCount() > 1) {
+        std::vector<size_t> bytes = NumaTopology::GetResidentBytesByNode(pool_, pool_size_);
+        if (!bytes.empty()) {
+            return bytes;
         }
-        i = j - 1;
     }
-    return -1;
+    return {GetResidentBytes()};
 }
 
 // 获取最大连续空闲块数
 size_t SharedMemoryPool::GetMaxContinuousFreeBlocks() const {
-    size_t maxContinuous = 0;
-    size_t currentContinuous = 0;
+    return used_map.MaxFreeRun();
+}
 
-    for (size_t i = 0; i < kBlockCount; ++i) {
-        if (!used_map[i]) {
-            currentContinuous++;
-            maxContinuous = std::max(maxContinuous, currentContinuous);
-        } else {
-            currentContinuous = 0;
+// 获取空闲碎片数量
+size_t SharedMemoryPool::GetFreeFragmentCount() const {
+    return used_map.CountFreeRuns();
+}
+
+SharedMemoryPool::FragmentationStats SharedMemoryPool::GetFragmentationStats() const {
+    FragmentationStats stats;
+    stats.free_blocks = free_block_count;
+    stats.fragment_count = used_map.CountFreeRuns();
+    stats.largest_free_run = used_map.MaxFreeRun();
+    stats.run_histogram = used_map.GetRunHistogram();
+    stats.cached_blocks = cached_blocks_;
+    return stats;
+}
+
+// 按线程编号选择区间缓存（调用方持有写锁）
+BlockRunCache* SharedMemoryPool::SelectRunCache() {
+    if (segment_ || run_caches_.empty()) {
+        return nullptr; // 共享段：其他进程的修改会按记录表重建位图，缓存的区间会丢失
+    }
+    return &run_caches_[t_thread_number % run_caches_.size()];
+}
+
+// 放入区间缓存（区间足够大、会立即归还物理页时不缓存）；到达回收间隔时归还闲置的区间
+bool SharedMemoryPool::CacheFreedRun(size_t start, size_t count) {
+    BlockRunCache* cache = SelectRunCache();
+    if (!cache || (release_threshold_ > 0 && count * block_size_ >= release_threshold_) ||
+        !cache->Push(start, count)) {
+        return false;
+    }
+    cached_blocks_ += count;
+    if (cache->Tick()) {
+        std::vector<BlockRunCache::Run> idle;
+        cache->TakeIdle(idle);
+        ReturnRuns(idle);
+    }
+    return true;
+}
+
+bool SharedMemoryPool::TakeCachedRun(size_t count, size_t& start) {
+    BlockRunCache* cache = SelectRunCache();
+    if (!cache || !cache->Pop(count, start)) {
+        return false;
+    }
+    cached_blocks_ -= count;
+    if (cache->Tick()) {
+        std::vector<BlockRunCache::Run> idle;
+        cache->TakeIdle(idle);
+        ReturnRuns(idle);
+    }
+    return true;
+}
+
+// 归还缓存的区间（块归属已是空闲，free_block_count 中已经计入）
+void SharedMemoryPool::ReturnRuns(const std::vector<BlockRunCache::Run>& runs) {
+    for (const BlockRunCache::Run& run : runs) {
+        MarkBlocksFree(run.start, run.count);
+        MaybeReleaseBlocks(run.start, run.count);
+        cached_blocks_ -= run.count;
+        if (run.start < next_search_pos_) {
+            next_search_pos_ = run.start;
         }
     }
+}
+
+void SharedMemoryPool::FlushRunCaches() {
+    if (cached_blocks_ == 0) {
+        return;
+    }
+    std::vector<BlockRunCache::Run> runs;
+    for (BlockRunCache& cache : run_caches_) {
+        cache.TakeAll(runs);
+    }
+    ReturnRuns(runs);
+}
 
-    return maxContinuous;
+// 获取 slab 各级别使用情况
+SlabAllocator::ClassStats SharedMemoryPool::GetSlabStats(int sizeClass) const {
+    return slab_allocator_.GetClassStats(sizeClass);
 }
 
 // 紧凑内存
+// 1. 按地址顺序遍历已使用的单元（一条分配记录或一个 slab 块），用前缀和计算每个单元的目标位置
+// 2. 单元 i 的目标区间只会覆盖在它之前、源区间与之相交的单元，这些单元必须先移走；
+//    按依赖关系分层（层号 = 依赖的最大层号 + 1），同一层的移动互不重叠，可以并行执行
+//    （碎片均匀分布时层数约为 log(单元数)）
+// 3. 每个单元整体 memmove 一次（源和目标不重叠时按分片并行复制），最后批量更新元数据
+// 有活动视图的单元留在原处，之后的单元从它的结尾继续排列（它前面的空洞保留）
 void SharedMemoryPool::Compact() {
-    size_t freePos = 0; // 下一个空闲位置
-    // 记录已经处理过的 memory_id，避免重复处理
-    std::set<std::string> processed;
-
-    // 按 memory_id 为单位移动：遍历 memory_info，按原始起始位置排序
-    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> sortedEntries;
-    for (const auto& entry : memory_info) {
-        sortedEntries.push_back(entry);
-    }
-    // 按起始块位置排序
-    std::sort(sortedEntries.begin(), sortedEntries.end(),
-              [](const auto& a, const auto& b) { return a.second.first < b.second.first; });
-
-    // 遍历每个 memory_id，移动其所有块
-    for (const auto& entry : sortedEntries) {
-        const std::string& memory_id = entry.first;
-        size_t oldStartBlock = entry.second.first;
-        size_t blockCount = entry.second.second;
-
-        // 跳过已处理的 memory_id
-        if (processed.find(memory_id) != processed.end()) {
+    struct Move {
+        size_t src;     // 源起始块
+        size_t dst;     // 目标起始块
+        size_t count;   // 块数量
+        uint32_t owner; // 记录下标、kSlabOwner 或 kReservedOwner
+        uint32_t level; // 依赖层号
+    };
+    FlushRunCaches(); // 缓存的块没有归属，先归还为空闲区间
+
+    // 规划：遍历位图中已使用的单元，目标位置为之前所有单元的块数之和
+    std::vector<Move> moves;
+    size_t freePos = 0;
+    for (size_t pos = used_map.FindNextUsed(0); pos < block_count_;) {
+        uint32_t owner = block_owner_[pos];
+        size_t count = UnitBlockCount(pos);
+        if (IsUnitPinned(pos)) {
+            freePos = pos;
+        }
+        moves.push_back(Move{pos, freePos, count, owner, 0});
+        freePos += count;
+        pos = used_map.FindNextUsed(pos + count);
+    }
+
+    // 分层：依赖的单元是源区间与目标区间相交的连续一段（源区间按地址有序）
+    uint32_t levelCount = 0;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        Move& move = moves[i];
+        if (move.src == move.dst) {
+            continue; // 不需要移动（最前面的单元或有活动视图的单元）
+        }
+        auto first = std::partition_point(moves.begin(), moves.begin() + i,
+                                          [&move](const Move& other) {
+                                              return other.src + other.count <= move.dst;
+                                          });
+        uint32_t level = 0;
+        for (auto it = first; it != moves.begin() + i && it->src < move.dst + move.count; ++it) {
+            level = std::max(level, it->level + 1);
+        }
+        move.level = level;
+        levelCount = std::max(levelCount, level + 1);
+    }
+
+    // 按层执行：一层的移动量足够大时分给多个线程，否则在当前线程中依次执行
+    size_t threads = compact_threads_ ? compact_threads_ : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(1, std::min(threads, kMaxCompactThreads));
+    const size_t chunkBlocks = std::max<size_t>(1, kCompactChunkBytes / block_size_);
+    std::vector<std::vector<const Move*>> levels(levelCount);
+    for (const Move& move : moves) {
+        if (move.src != move.dst) {
+            levels[move.level].push_back(&move);
+        }
+    }
+    struct CopyTask {
+        size_t src;
+        size_t dst;
+        size_t count;
+    };
+    std::vector<CopyTask> tasks;
+    for (const auto& level : levels) {
+        size_t levelBlocks = 0;
+        for (const Move* move : level) {
+            levelBlocks += move->count;
+        }
+        if (threads == 1 || levelBlocks * block_size_ < kParallelCompactBytes) {
+            for (const Move* move : level) {
+                std::memmove(pool_ + move->dst * block_size_, pool_ + move->src * block_size_,
+                             move->count * block_size_);
+            }
             continue;
         }
 
-        // 移动这个 memory_id 的所有块
-        for (size_t j = 0; j < blockCount; ++j) {
-            size_t srcBlock = oldStartBlock + j;
-            size_t dstBlock = freePos + j;
-
-            if (srcBlock != dstBlock) {
-                // 移动数据
-                memcpy(pool_ + dstBlock * kBlockSize, pool_ + srcBlock * kBlockSize, kBlockSize);
-                // 移动元数据
-                meta_[dstBlock] = meta_[srcBlock];
-                // 清理源位置
-                meta_[srcBlock] = BlockMeta{};
-                // 更新 used_map
-                used_map.set(dstBlock, true);
-                used_map.set(srcBlock, false);
+        // 源和目标不重叠的移动按分片拆开，重叠的移动只能整体 memmove
+        tasks.clear();
+        for (const Move* move : level) {
+            bool overlapped = move->dst + move->count > move->src;
+            size_t step = overlapped ? move->count : chunkBlocks;
+            for (size_t offset = 0; offset < move->count; offset += step) {
+                size_t count = std::min(step, move->count - offset);
+                tasks.push_back(CopyTask{move->src + offset, move->dst + offset, count});
             }
         }
+        std::atomic<size_t> next{0};
+        auto worker = [this, &tasks, &next]() {
+            for (size_t i = next++; i < tasks.size(); i = next++) {
+                const CopyTask& task = tasks[i];
+                std::memmove(pool_ + task.dst * block_size_, pool_ + task.src * block_size_,
+                             task.count * block_size_);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < std::min(threads, tasks.size()); ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
 
-        // 更新 memory_info 中的起始位置
-        auto it = memory_info.find(memory_id);
-        if (it != memory_info.end()) {
-            it->second.first = freePos;
+    // 更新块归属、记录和 slab（按地址顺序，目标块号不会与尚未处理的源块号冲突）
+    for (const Move& move : moves) {
+        if (move.src != move.dst) {
+            UpdateUnitLocation(move.src, move.dst, move.count, move.owner);
         }
+    }
 
-        processed.insert(memory_id);
-        freePos += blockCount;
+    // 紧凑后已使用块位于前端（和有活动视图的单元处），按区间批量更新 used_map、块归属和空闲索引
+    if (free_index_) {
+        free_index_->Clear();
+    }
+    free_block_count = 0;
+    size_t firstFree = block_count_;
+    size_t usedStart = 0;
+    size_t usedEnd = 0;
+    for (size_t i = 0; i <= moves.size(); ++i) {
+        size_t next = (i < moves.size()) ? moves[i].dst : block_count_;
+        if (i < moves.size() && next == usedEnd) {
+            usedEnd += moves[i].count;
+            continue;
+        }
+        // 连续的已使用区间 [usedStart, usedEnd) 之后是空闲区间 [usedEnd, next)
+        used_map.SetRange(usedStart, usedEnd - usedStart, true);
+        resident_map_.SetRange(usedStart, usedEnd - usedStart, true);
+        size_t gap = next - usedEnd;
+        if (gap > 0) {
+            std::fill(block_owner_.begin() + usedEnd, block_owner_.begin() + next, kNoOwner);
+            used_map.SetRange(usedEnd, gap, false);
+            if (free_index_) {
+                free_index_->Insert(usedEnd, gap);
+            }
+            free_block_count += gap;
+            firstFree = std::min(firstFree, usedEnd);
+            // 空闲区间中常驻的部分达到阈值时归还物理页
+            if (ShouldReleaseResident(usedEnd, gap)) {
+                ReleaseBlocks(usedEnd, gap);
+            }
+        }
+        if (i < moves.size()) {
+            usedStart = next;
+            usedEnd = next + moves[i].count;
+        }
     }
 
-    // 更新空闲块计数
-    free_block_count = kBlockCount - freePos;
+    // 更新搜索起始位置为第一个空闲位置，增量紧凑从头开始
+    next_search_pos_ = firstFree;
+    compact_cursor_ = 0;
+    publish_all_ = true; // 共享段：所有记录的起始位置都可能改变
+}
 
-    // 更新搜索起始位置为第一个空闲位置
-    next_search_pos_ = freePos;
+// 增量紧凑（按移动字节数限制）
+bool SharedMemoryPool::CompactStep(size_t maxBytes) {
+    FlushRunCaches();
+    size_t movedBytes = 0;
+    do {
+        if (!CompactNextUnit(movedBytes)) {
+            return true;
+        }
+    } while (movedBytes < maxBytes);
+    return false;
+}
+
+// 增量紧凑（按时间预算限制）
+bool SharedMemoryPool::CompactFor(std::chrono::microseconds budget) {
+    FlushRunCaches();
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    size_t movedBytes = 0;
+    do {
+        if (!CompactNextUnit(movedBytes)) {
+            return true;
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+}
+
+// 移动游标之后的下一个单元
+bool SharedMemoryPool::CompactNextUnit(size_t& movedBytes) {
+    // 游标之后的第一个空洞，以及空洞后面的第一个已使用块
+    size_t hole = (compact_cursor_ < block_count_) ? used_map.FindFreeRun(1, compact_cursor_)
+                                                   : FreeSpaceBitmap::npos;
+    size_t unit = (hole == FreeSpaceBitmap::npos) ? block_count_ : used_map.FindNextUsed(hole);
+    if (unit >= block_count_) {
+        // 已使用块都已移动到前端，尾部空闲区中常驻的部分达到阈值时分段归还物理页
+        // （每次归还到下一个 kCompactReleaseBytes 对齐的位置，避免一次归还整个尾部）
+        size_t tail = (hole == FreeSpaceBitmap::npos) ? block_count_ : hole;
+        if (tail < block_count_ && ShouldReleaseResident(tail, block_count_ - tail)) {
+            size_t chunkBlocks = std::max<size_t>(1, kCompactReleaseBytes / block_size_);
+            size_t end = std::min(block_count_, (tail / chunkBlocks + 1) * chunkBlocks);
+            ReleaseBlocks(tail, end - tail);
+            compact_cursor_ = end;
+            movedBytes += (end - tail) * block_size_;
+            return true;
+        }
+        next_search_pos_ = tail;
+        compact_cursor_ = 0;
+        return false;
+    }
+
+    // 空洞后面是一条分配记录的起始块、一个 slab 块或预留区间；有活动视图或预留时跳过，空洞保留
+    uint32_t owner = block_owner_[unit];
+    size_t count = UnitBlockCount(unit);
+    if (IsUnitPinned(unit)) {
+        compact_cursor_ = unit + count;
+        return true;
+    }
+    std::memmove(pool_ + hole * block_size_, pool_ + unit * block_size_, count * block_size_);
+
+    // 先释放原区间（与前面的空洞合并），再占用空洞开头
+    std::fill(block_owner_.begin() + unit, block_owner_.begin() + unit + count, kNoOwner);
+    MarkBlocksFree(unit, count);
+    MarkBlocksUsed(hole, count);
+    UpdateUnitLocation(unit, hole, count, owner);
+
+    compact_cursor_ = hole + count;
+    movedBytes += count * block_size_;
+    return true;
+}
+
+// 更新移动后的单元位置（slab 块上的所有小对象一起更新）
+void SharedMemoryPool::UpdateUnitLocation(size_t src, size_t dst, size_t count, uint32_t owner) {
+    std::fill(block_owner_.begin() + dst, block_owner_.begin() + dst + count, owner);
+    if (owner != kSlabOwner) {
+        records_[owner].start_block = dst;
+        MarkRecordDirty(owner);
+        return;
+    }
+    uint64_t usedMask = slab_allocator_.GetSlabs().at(src).used_mask;
+    slab_allocator_.Move(src, dst);
+    for (size_t slot = 0; slot < SlabAllocator::kMaxSlotCount; ++slot) {
+        if (!(usedMask >> slot & 1)) {
+            continue;
+        }
+        auto it = slab_slot_owner_.find(SlabSlotKey(src, slot));
+        uint32_t index = it->second;
+        slab_slot_owner_.erase(it);
+        slab_slot_owner_[SlabSlotKey(dst, slot)] = index;
+        records_[index].start_block = dst;
+        MarkRecordDirty(index);
+    }
+}
+
+// 定向紧凑
+// 代价模型：窗口 [s, s + blockCount) 的代价是与它相交的所有单元的块数之和
+// （部分相交的单元也要整体搬走）。候选起点为 0、每个单元的起点和终点；
+// 单元按地址有序，用前缀和与双指针在 O(单元数) 内找到代价最小的窗口。
+// 比最大空闲区间还大的单元无处可搬、有活动视图的单元不能搬，包含这种单元的窗口不可行
+int SharedMemoryPool::EvacuateWindow(size_t blockCount) {
+    if (blockCount == 0 || blockCount > block_count_) {
+        return -1;
+    }
+    FlushRunCaches(); // 缓存的块没有归属，不能作为单元搬迁
+    struct Unit {
+        size_t start;
+        size_t count;
+    };
+    std::vector<Unit> units;
+    std::vector<size_t> blocksBefore{0}; // 前缀和：前 i 个单元的块数
+    std::vector<size_t> pinnedBefore{0}; // 前缀和：前 i 个单元中不能搬的单元数
+    const size_t maxRun = used_map.MaxFreeRun();
+    for (size_t pos = used_map.FindNextUsed(0); pos < block_count_;) {
+        size_t count = UnitBlockCount(pos);
+        units.push_back(Unit{pos, count});
+        blocksBefore.push_back(blocksBefore.back() + count);
+        bool pinned = count > maxRun || IsUnitPinned(pos);
+        pinnedBefore.push_back(pinnedBefore.back() + (pinned ? 1 : 0));
+        pos = used_map.FindNextUsed(pos + count);
+    }
+
+    const size_t lastStart = block_count_ - blockCount;
+    size_t bestCost = SIZE_MAX;
+    size_t bestStart = 0;
+    size_t lo = 0; // 第一个终点在窗口起点之后的单元
+    size_t hi = 0; // 第一个起点不在窗口内的单元
+    auto evaluate = [&](size_t start) {
+        if (start > lastStart) {
+            return;
+        }
+        size_t end = start + blockCount;
+        while (lo < units.size() && units[lo].start + units[lo].count <= start) {
+            ++lo;
+        }
+        hi = std::max(hi, lo);
+        while (hi < units.size() && units[hi].start < end) {
+            ++hi;
+        }
+        if (pinnedBefore[hi] != pinnedBefore[lo]) {
+            return;
+        }
+        size_t cost = blocksBefore[hi] - blocksBefore[lo];
+        // 窗口外的空闲块要能容纳搬出的块（窗口内的已使用块 = 代价减去两端伸出窗口的部分）
+        size_t usedInside = cost;
+        if (lo < hi) {
+            usedInside -= (units[lo].start < start) ? start - units[lo].start : 0;
+            size_t lastEnd = units[hi - 1].start + units[hi - 1].count;
+            usedInside -= (lastEnd > end) ? lastEnd - end : 0;
+        }
+        size_t freeOutside = free_block_count - (blockCount - usedInside);
+        if (cost < bestCost && cost <= freeOutside) {
+            bestCost = cost;
+            bestStart = start;
+        }
+    };
+    evaluate(0);
+    for (const Unit& unit : units) {
+        evaluate(unit.start);
+        evaluate(unit.start + unit.count);
+    }
+    evaluate(lastStart);
+    if (bestCost == SIZE_MAX) {
+        return -1;
+    }
+
+    // 预留窗口内的空闲区间（只标记位图、移出空闲索引），阻挡的单元不会被搬进窗口
+    const size_t start = bestStart;
+    const size_t end = start + blockCount;
+    std::vector<std::pair<size_t, size_t>> windowFree; // 搬迁结束后归还的窗口内区间
+    for (size_t pos = start; pos < end;) {
+        size_t freeStart = used_map.FindFreeRun(1, pos);
+        if (freeStart == FreeSpaceBitmap::npos || freeStart >= end) {
+            break;
+        }
+        size_t freeEnd = std::min(used_map.FindNextUsed(freeStart), end);
+        if (free_index_) {
+            free_index_->Remove(FreeRunHead(freeStart), freeStart, freeEnd - freeStart);
+        }
+        used_map.SetRange(freeStart, freeEnd - freeStart, true);
+        windowFree.emplace_back(freeStart, freeEnd - freeStart);
+        pos = freeEnd;
+    }
+
+    // 搬走窗口中的单元（从大到小，大的更难找到位置）
+    std::vector<Unit> blockers;
+    for (const Unit& unit : units) {
+        if (unit.start < end && unit.start + unit.count > start) {
+            blockers.push_back(unit);
+        }
+    }
+    std::sort(blockers.begin(), blockers.end(),
+              [](const Unit& a, const Unit& b) { return a.count > b.count; });
+    bool evacuated = true;
+    for (const Unit& unit : blockers) {
+        size_t dst = free_index_ ? free_index_->Find(unit.count)
+                                 : used_map.FindFreeRun(unit.count, 0);
+        if (dst == FreeBlockIndex::npos) {
+            evacuated = false;
+            break;
+        }
+        std::memcpy(pool_ + dst * block_size_, pool_ + unit.start * block_size_,
+                    unit.count * block_size_);
+        MarkBlocksUsed(dst, unit.count);
+        uint32_t owner = block_owner_[unit.start];
+        std::fill(block_owner_.begin() + unit.start,
+                  block_owner_.begin() + unit.start + unit.count, kNoOwner);
+        UpdateUnitLocation(unit.start, dst, unit.count, owner);
+
+        // 旧位置中窗口外的部分立即释放，窗口内的部分最后与窗口一起释放
+        size_t insideStart = std::max(unit.start, start);
+        size_t insideEnd = std::min(unit.start + unit.count, end);
+        if (unit.start < insideStart) {
+            MarkBlocksFree(unit.start, insideStart - unit.start);
+        }
+        if (unit.start + unit.count > insideEnd) {
+            MarkBlocksFree(insideEnd, unit.start + unit.count - insideEnd);
+        }
+        windowFree.emplace_back(insideStart, insideEnd - insideStart);
+    }
+
+    // 释放窗口（搬迁失败时只释放已经腾空的部分，没搬走的单元留在原处）
+    for (const auto& range : windowFree) {
+        MarkBlocksFree(range.first, range.second);
+    }
+    return evacuated ? static_cast<int>(start) : -1;
+}
+
+// 分配失败时的紧凑
+int SharedMemoryPool::CompactUntilFree(size_t blockCount) {
+    // 从游标继续，到达末尾后再从头完整执行一轮（此时所有空闲块都合并到尾部）
+    FlushRunCaches();
+    bool fromStart = (compact_cursor_ == 0);
+    size_t movedBytes = 0;
+    while (true) {
+        if (!CompactNextUnit(movedBytes)) {
+            if (fromStart) {
+                break;
+            }
+            fromStart = true;
+            continue;
+        }
+        // 刚移动的单元后面的空闲区间已经足够大
+        size_t start = compact_cursor_;
+        if (used_map.FindNextUsed(start) - start >= blockCount) {
+            return static_cast<int>(start);
+        }
+    }
+    return FindFreeBlock(blockCount);
 }
 
 // 分配内存
@@ -318,159 +1323,769 @@ int SharedMemoryPool::AllocateBlock(const std::string& memory_id, const std::str
     if (dataSize == 0 || memory_id.empty() || data == nullptr) {
         return -1;
     }
+    // 内存ID已存在（需要先释放）
+    if (memory_index_.Contains(memory_id)) {
+        return -1;
+    }
+    // 共享段：记录表已满或内存ID超出条目长度
+    if (!HasRecordCapacity() || (segment_ && memory_id.size() >= SharedSegment::kIdSize)) {
+        return -1;
+    }
+
+    // 小对象（含结尾 0）放入 slab 槽位，多个对象共享一个块
+    int sizeClass = slab_allocator_.SizeClassFor(dataSize + 1);
+    if (sizeClass >= 0) {
+        return AllocateSlabObject(memory_id, description, data, dataSize, sizeClass);
+    }
 
-    // 计算需要的块数（向上取整）
-    size_t requiredBlocks = (dataSize + kBlockSize) / kBlockSize;
+    // 计算需要的块数（向上取整，并为结尾的 0 预留 1 字节）
+    size_t requiredBlocks = (dataSize + block_size_) / block_size_;
 
     // 检查总空闲空间是否足够
-    size_t totalFreeSpace = static_cast<size_t>(free_block_count) * kBlockSize;
+    size_t totalFreeSpace = static_cast<size_t>(free_block_count) * block_size_;
     if (dataSize > totalFreeSpace) {
         return -1; // 空间不足
     }
 
-    // 尝试查找连续的空闲块
-    int startBlock = FindContinuousFreeBlock(requiredBlocks);
+    // 紧凑后仍然找不到（有活动视图或预留的单元不能搬动）
+    int startBlock = ClaimRun(requiredBlocks);
+    if (startBlock == -1) {
+        return -1;
+    }
+    size_t start = static_cast<size_t>(startBlock);
+
+    // 写入数据，最后一个块的剩余部分清零
+    uint8_t* dst = pool_ + start * block_size_;
+    memcpy(dst, data, dataSize);
+    memset(dst + dataSize, 0, requiredBlocks * block_size_ - dataSize);
+
+    // 记录分配信息，块只记录归属的记录下标
+    uint32_t index = NewRecord(memory_id);
+    AllocationRecord& record = records_[index];
+    record.description = description;
+    record.start_block = start;
+    record.block_count = requiredBlocks;
+    record.byte_length = dataSize;
+    record.last_modified = std::time(nullptr);
+    std::fill(block_owner_.begin() + start, block_owner_.begin() + start + requiredBlocks, index);
+    return startBlock;
+}
+
+// 取得整块区间
+int SharedMemoryPool::ClaimRun(size_t blockCount) {
+    if (blockCount > free_block_count) {
+        return -1;
+    }
+    // 先从区间缓存中取相同块数的区间（仍标记为已使用，不需要查找和更新空闲区间）
+    size_t start = 0;
+    if (!TakeCachedRun(blockCount, start)) {
+        int found = FindOrMakeFreeBlock(blockCount);
+        if (found == -1) {
+            return -1;
+        }
+        start = static_cast<size_t>(found);
+        MarkBlocksUsed(start, blockCount);
+    }
+    free_block_count -= blockCount;
+
+    // 更新 Next Fit 搜索起始位置为分配结束位置
+    next_search_pos_ = start + blockCount;
+    return static_cast<int>(start);
+}
+
+// 查找连续空闲块，必要时紧凑
+int SharedMemoryPool::FindOrMakeFreeBlock(size_t blockCount) {
+    // 按分配策略查找连续的空闲块（Best Fit / TLSF 不受 Next Fit 游标位置限制）
+    int startBlock = FindFreeBlock(blockCount);
+    // 区间缓存中的块可能正好补上缺口，先全部归还再查找
+    if (startBlock == -1 && cached_blocks_ > 0) {
+        FlushRunCaches();
+        startBlock = FindFreeBlock(blockCount);
+    }
 
-    // 如果找不到连续块，但总空间足够，进行紧凑
+    // 找不到足够大的空闲区间时才进行紧凑：先只搬走代价最小的窗口中的分配，
+    // 不可行时再增量紧凑到出现足够大的空闲区间为止
+    if (startBlock == -1) {
+        startBlock = EvacuateWindow(blockCount);
+    }
     if (startBlock == -1) {
-        Compact();
-        // 紧凑后重新查找
-        startBlock = FindContinuousFreeBlock(requiredBlocks);
-        if (startBlock == -1) {
-            return -1; // 紧凑后仍然找不到（理论上不应该发生）
+        startBlock = CompactUntilFree(blockCount);
+    }
+    return startBlock;
+}
+
+// 更新内存内容
+int SharedMemoryPool::Update(const std::string& memory_id, const void* data, size_t dataSize) {
+    // 与 AllocateBlock 相同的参数检查
+    if (dataSize == 0 || memory_id.empty() || data == nullptr) {
+        return -1;
+    }
+    const uint32_t index = memory_index_.Find(memory_id);
+    if (index == MemoryIdIndex::npos) {
+        return -1;
+    }
+    AllocationRecord& record = records_[index];
+    const int sizeClass = slab_allocator_.SizeClassFor(dataSize + 1);
+    const size_t start = record.start_block;
+    const size_t count = record.block_count;
+
+    // 有活动视图时只能原位覆盖，不能搬迁、扩展或缩小
+    if (IsRecordPinned(index)) {
+        bool inPlace = (record.slab_slot >= 0)
+                           ? sizeClass == slab_allocator_.GetSizeClass(start)
+                           : (dataSize + block_size_) / block_size_ == count;
+        if (!inPlace) {
+            return -1;
         }
     }
 
-    // 分配块并写入数据
-    size_t bytesWritten = 0;
-    for (size_t i = 0; i < requiredBlocks; ++i) {
-        size_t blockId = static_cast<size_t>(startBlock) + i;
-        size_t bytesToWrite = std::min(kBlockSize, dataSize - bytesWritten);
+    if (record.slab_slot >= 0) {
+        // 仍属于同一级别的 slab 小对象直接覆盖槽位
+        if (sizeClass == slab_allocator_.GetSizeClass(start)) {
+            size_t slotSize = slab_allocator_.SlotSize(sizeClass);
+            uint8_t* dst = pool_ + start * block_size_ + record.slab_slot * slotSize;
+            memcpy(dst, data, dataSize);
+            memset(dst + dataSize, 0, slotSize - dataSize);
+            record.byte_length = dataSize;
+            record.last_modified = std::time(nullptr);
+            MarkRecordDirty(index);
+            return static_cast<int>(start);
+        }
 
-        // 写入数据
-        memcpy(pool_ + blockId * kBlockSize, static_cast<const uint8_t*>(data) + bytesWritten,
-               bytesToWrite);
+        // 级别变化时先取得并写入新位置，成功后才释放原槽位；失败时原内容和记录保持不变
+        // （取得新位置时的紧凑可能搬动原槽位所在的 slab 块，之后重新读取记录位置）
+        size_t newBlock = 0;
+        size_t newSlot = 0;
+        size_t newCount = 1;
+        uint8_t* dst = nullptr;
+        size_t capacity = 0;
+        if (sizeClass >= 0) {
+            if (!ClaimSlabSlot(sizeClass, newBlock, newSlot)) {
+                return -1;
+            }
+            capacity = slab_allocator_.SlotSize(sizeClass);
+            dst = pool_ + newBlock * block_size_ + newSlot * capacity;
+        } else {
+            newCount = (dataSize + block_size_) / block_size_;
+            int found = ClaimRun(newCount);
+            if (found == -1) {
+                return -1;
+            }
+            newBlock = static_cast<size_t>(found);
+            std::fill(block_owner_.begin() + newBlock, block_owner_.begin() + newBlock + newCount,
+                      index);
+            capacity = newCount * block_size_;
+            dst = pool_ + newBlock * block_size_;
+        }
+        memcpy(dst, data, dataSize);
+        memset(dst + dataSize, 0, capacity - dataSize);
+
+        const size_t oldBlock = record.start_block;
+        const size_t oldSlot = static_cast<size_t>(record.slab_slot);
+        slab_slot_owner_.erase(SlabSlotKey(oldBlock, oldSlot));
+        FreeSlabObject(oldBlock, oldSlot);
+        if (sizeClass >= 0) {
+            slab_slot_owner_[SlabSlotKey(newBlock, newSlot)] = index;
+        }
+        record.start_block = newBlock;
+        record.block_count = newCount;
+        record.slab_slot = (sizeClass >= 0) ? static_cast<int32_t>(newSlot) : -1;
+        record.byte_length = dataSize;
+        record.last_modified = std::time(nullptr);
+        MarkRecordDirty(index);
+        return static_cast<int>(newBlock);
+    }
 
-        // 如果块没有写满，剩余部分清零
-        if (bytesToWrite < kBlockSize) {
-            memset(pool_ + blockId * kBlockSize + bytesToWrite, 0, kBlockSize - bytesToWrite);
+    // 整块内存（为结尾的 0 预留 1 字节；新内容即使可以放入 slab 也留在原处）
+    const size_t requiredBlocks = (dataSize + block_size_) / block_size_;
+    size_t newStart = start;
+    if (requiredBlocks > count) {
+        size_t extra = requiredBlocks - count;
+        size_t tail = start + count;
+        // 后面紧邻的块可能刚释放进区间缓存（位图中仍为已使用、没有归属），先归还再判断
+        for (size_t b = tail; cached_blocks_ > 0 && b < std::min(tail + extra, block_count_); ++b) {
+            if (block_owner_[b] != kNoOwner) {
+                break; // 属于其他单元，不能原地扩展
+            }
+            if (used_map.Test(b)) {
+                FlushRunCaches();
+                break;
+            }
         }
+        if (tail + extra <= block_count_ && used_map.FindNextUsed(tail) >= tail + extra) {
+            // 原地扩展到后面紧邻的空闲块
+            std::fill(block_owner_.begin() + tail, block_owner_.begin() + tail + extra, index);
+            MarkBlocksUsed(tail, extra);
+            free_block_count -= extra;
+        } else {
+            // 先取得新位置，原区间仍属于该记录，成功后才释放；失败时原内容和记录保持不变
+            // （原区间不能计入可用空间：紧凑时它只会被整体搬动，不会并入新位置）
+            int found = ClaimRun(requiredBlocks);
+            if (found == -1) {
+                return -1;
+            }
+            newStart = static_cast<size_t>(found);
+            std::fill(block_owner_.begin() + newStart,
+                      block_owner_.begin() + newStart + requiredBlocks, index);
+            FreeRun(record.start_block, count); // 紧凑可能搬动了原区间
+            record.start_block = newStart;
+        }
+        record.block_count = requiredBlocks;
+    }
 
-        // 设置元数据
-        meta_[blockId].used = true;
-        meta_[blockId].memory_id = memory_id;
-        meta_[blockId].description = description;
-        used_map.set(blockId, true);
-        free_block_count--;
+    // 写入数据，最后一个块的剩余部分清零，放得下时释放多余的尾部块
+    uint8_t* dst = pool_ + newStart * block_size_;
+    memcpy(dst, data, dataSize);
+    memset(dst + dataSize, 0, requiredBlocks * block_size_ - dataSize);
+    ShrinkRecord(index, requiredBlocks);
+    record.byte_length = dataSize;
+    record.last_modified = std::time(nullptr);
+    MarkRecordDirty(index);
+    return static_cast<int>(newStart);
+}
 
-        bytesWritten += bytesToWrite;
+// 分配 slab 小对象
+int SharedMemoryPool::AllocateSlabObject(const std::string& memory_id,
+                                         const std::string& description, const void* data,
+                                         size_t dataSize, int sizeClass) {
+    size_t block = 0;
+    size_t slot = 0;
+    if (!ClaimSlabSlot(sizeClass, block, slot)) {
+        return -1;
     }
 
-    memory_info[memory_id].first = startBlock;
-    memory_info[memory_id].second = requiredBlocks;
-    // 更新最后修改时间
-    memory_last_modified_time[memory_id] = std::time(nullptr);
+    // 写入数据，槽位剩余部分清零
+    size_t slotSize = slab_allocator_.SlotSize(sizeClass);
+    uint8_t* dst = pool_ + block * block_size_ + slot * slotSize;
+    memcpy(dst, data, dataSize);
+    memset(dst + dataSize, 0, slotSize - dataSize);
+
+    uint32_t index = NewRecord(memory_id);
+    AllocationRecord& record = records_[index];
+    record.description = description;
+    record.start_block = block;
+    record.block_count = 1;
+    record.byte_length = dataSize;
+    record.last_modified = std::time(nullptr);
+    record.slab_slot = static_cast<int32_t>(slot);
+    slab_slot_owner_[SlabSlotKey(block, slot)] = index;
+    return static_cast<int>(block);
+}
 
-    // 更新搜索起始位置为分配位置+块数（next_search_pos_ 已经在 FindContinuousFreeBlock 中更新）
+// 取得 slab 槽位
+bool SharedMemoryPool::ClaimSlabSlot(int sizeClass, size_t& block, size_t& slot) {
+    if (slab_allocator_.AllocateSlot(sizeClass, block, slot)) {
+        return true;
+    }
+    // 该级别没有未满的 slab，从区间缓存或内存池取一个块作为新的 slab
+    bool cached = TakeCachedRun(1, block);
+    if (!cached) {
+        int newBlock = FindFreeBlock(1);
+        if (newBlock == -1) {
+            if (free_block_count == 0) {
+                return false; // 空间不足
+            }
+            newBlock = CompactUntilFree(1); // 会先归还区间缓存
+            if (newBlock == -1) {
+                return false;
+            }
+        }
+        block = static_cast<size_t>(newBlock);
+        MarkBlocksUsed(block, 1);
+        next_search_pos_ = block + 1;
+    }
+    block_owner_[block] = kSlabOwner;
+    free_block_count--;
+    slab_allocator_.AddSlab(block, sizeClass);
+    slab_allocator_.AllocateSlot(sizeClass, block, slot);
+    return true;
+}
 
-    return startBlock;
+// 释放 slab 小对象（slab 变空时归还块）
+void SharedMemoryPool::FreeSlabObject(size_t block, size_t slot) {
+    if (!slab_allocator_.FreeSlot(block, slot)) {
+        return;
+    }
+    block_owner_[block] = kNoOwner;
+    free_block_count++;
+    if (CacheFreedRun(block, 1)) {
+        return;
+    }
+    MarkBlocksFree(block, 1);
+    MaybeReleaseBlocks(block, 1);
+    if (block < next_search_pos_) {
+        next_search_pos_ = block;
+    }
 }
 
 // 释放指定内存ID的所有内存
 bool SharedMemoryPool::FreeByMemoryId(const std::string& memory_id) {
-    if (memory_info.find(memory_id) == memory_info.end())
+    uint32_t index = memory_index_.Find(memory_id);
+    if (index == MemoryIdIndex::npos)
+        return false;
+    // 有活动视图时不能释放（GetViewCount 可以区分）
+    if (IsRecordPinned(index))
         return false;
-    const auto& blockInfo = memory_info[memory_id];
-    size_t start = blockInfo.first;
-    size_t count = blockInfo.second;
-    for (size_t i = start; i < start + count; i++) {
-        used_map.set(i, false);
-        meta_[i] = BlockMeta{};
-    }
-    memory_info.erase(memory_id);
-    memory_last_modified_time.erase(memory_id); // 删除最后修改时间记录
+    const AllocationRecord& record = records_[index];
+    size_t start = record.start_block;
+    size_t count = record.block_count;
+
+    if (record.slab_slot >= 0) {
+        slab_slot_owner_.erase(SlabSlotKey(start, record.slab_slot));
+        FreeSlabObject(start, static_cast<size_t>(record.slab_slot));
+        ReleaseRecord(index);
+        return true;
+    }
+
+    ReleaseRecord(index);
+    FreeRun(start, count);
+    return true;
+}
+
+// 释放整块区间
+void SharedMemoryPool::FreeRun(size_t start, size_t count) {
+    std::fill(block_owner_.begin() + start, block_owner_.begin() + start + count, kNoOwner);
     free_block_count += count;
+    // 短区间留在区间缓存中，之后分配相同块数时直接复用
+    if (CacheFreedRun(start, count)) {
+        return;
+    }
+    MarkBlocksFree(start, count);
+    MaybeReleaseBlocks(start, count);
 
     // 如果释放的位置更靠前，更新搜索起始位置
     if (start < next_search_pos_) {
         next_search_pos_ = start;
     }
+}
 
-    return true;
+// 单元的块数
+size_t SharedMemoryPool::UnitBlockCount(size_t start) const {
+    uint32_t owner = block_owner_[start];
+    if (owner == kSlabOwner) {
+        return 1;
+    }
+    if (owner == kReservedOwner) {
+        return reservations_.at(reserved_starts_.at(start)).count;
+    }
+    return records_[owner].block_count;
 }
 
-// 释放指定块
+// 释放块所属的整个分配
 bool SharedMemoryPool::FreeByBlockId(size_t blockId) {
-    if (!used_map[blockId])
+    if (blockId >= block_count_)
         return false;
-    used_map.set(blockId, false);
-    meta_[blockId] = BlockMeta{};
-    free_block_count++;
+    // slab 块由其中的小对象共同管理，不能单独释放
+    uint32_t owner = block_owner_[blockId];
+    if (owner == kNoOwner || owner == kSlabOwner || owner == kReservedOwner)
+        return false;
+    std::string memory_id = records_[owner].memory_id;
+    return FreeByMemoryId(memory_id);
+}
 
-    // 如果释放的位置更靠前，更新搜索起始位置
-    if (blockId < next_search_pos_) {
-        next_search_pos_ = blockId;
+// 预留整块区间（与 AllocateBlock 相同的查找方式，块归属为 kReservedOwner）
+bool SharedMemoryPool::Reserve(size_t size, const std::string& description, uint8_t*& data,
+                               uint64_t& ticket) {
+    if (size == 0 || segment_) {
+        return false; // 共享段：其他进程按记录表重建位图，看不到预留的区间
+    }
+    size_t requiredBlocks = (size + block_size_) / block_size_;
+    int found = ClaimRun(requiredBlocks);
+    if (found == -1) {
+        return false;
+    }
+    size_t start = static_cast<size_t>(found);
+    std::fill(block_owner_.begin() + start, block_owner_.begin() + start + requiredBlocks,
+              kReservedOwner);
+
+    ticket = next_ticket_++;
+    reservations_[ticket] = Reservation{start, requiredBlocks, size, description};
+    reserved_starts_[start] = ticket;
+    data = pool_ + start * block_size_;
+    return true;
+}
+
+// 提交预留：建立分配记录，内容之后的部分清零，释放多余的尾部块
+int SharedMemoryPool::Commit(uint64_t ticket, const std::string& memory_id, size_t actualSize) {
+    if (!CanCommit(ticket, actualSize) || memory_id.empty() || memory_index_.Contains(memory_id)) {
+        return -1;
+    }
+    auto it = reservations_.find(ticket);
+    const Reservation reservation = it->second;
+    reserved_starts_.erase(reservation.start);
+    reservations_.erase(it);
+
+    uint8_t* dst = pool_ + reservation.start * block_size_;
+    memset(dst + actualSize, 0, reservation.count * block_size_ - actualSize);
+    uint32_t index = NewRecord(memory_id);
+    AllocationRecord& record = records_[index];
+    record.description = reservation.description;
+    record.start_block = reservation.start;
+    record.block_count = reservation.count;
+    record.byte_length = actualSize;
+    record.last_modified = std::time(nullptr);
+    std::fill(block_owner_.begin() + reservation.start,
+              block_owner_.begin() + reservation.start + reservation.count, index);
+    ShrinkRecord(index, (actualSize + block_size_) / block_size_);
+    return static_cast<int>(reservation.start);
+}
+
+bool SharedMemoryPool::CanCommit(uint64_t ticket, size_t actualSize) const {
+    auto it = reservations_.find(ticket);
+    return it != reservations_.end() && actualSize > 0 && actualSize <= it->second.size;
+}
+
+// 放弃预留，归还区间
+bool SharedMemoryPool::Abort(uint64_t ticket) {
+    auto it = reservations_.find(ticket);
+    if (it == reservations_.end()) {
+        return false;
+    }
+    size_t start = it->second.start;
+    size_t count = it->second.count;
+    reserved_starts_.erase(start);
+    reservations_.erase(it);
+    FreeRun(start, count);
+    return true;
+}
+
+// 加载时恢复分配记录
+bool SharedMemoryPool::RestoreAllocation(const AllocationRecord& record) {
+    if (record.memory_id.empty() || memory_index_.Contains(record.memory_id) ||
+        !HasRecordCapacity() ||
+        (segment_ && record.memory_id.size() >= SharedSegment::kIdSize) ||
+        record.block_count == 0 || record.start_block + record.block_count > block_count_) {
+        return false;
     }
+    uint32_t index = NewRecord(record.memory_id);
+    records_[index] = record;
 
+    // slab 小对象所在的块由 RestoreSlab 标记
+    if (record.slab_slot >= 0) {
+        slab_slot_owner_[SlabSlotKey(record.start_block, record.slab_slot)] = index;
+        return true;
+    }
+    size_t start = record.start_block;
+    std::fill(block_owner_.begin() + start, block_owner_.begin() + start + record.block_count,
+              index);
+    MarkBlocksUsed(start, record.block_count);
+    free_block_count -= record.block_count;
     return true;
 }
 
-// 清理块元数据
-void SharedMemoryPool::ClearBlockMeta(size_t blockId) {
-    used_map.set(blockId, false);
-    meta_[blockId].used = false;
-    meta_[blockId].memory_id.clear();
-    meta_[blockId].description.clear();
+// 加载时恢复 slab
+bool SharedMemoryPool::RestoreSlab(size_t block, int sizeClass, uint64_t usedMask) {
+    if (block >= block_count_ || used_map[block] || sizeClass < 0 ||
+        sizeClass >= static_cast<int>(SlabAllocator::kClassCount)) {
+        return false;
+    }
+    block_owner_[block] = kSlabOwner;
+    MarkBlocksUsed(block, 1);
+    free_block_count--;
+    slab_allocator_.RestoreSlab(block, sizeClass, usedMask);
+    return true;
 }
 
 // 获取内存最后修改时间
 time_t SharedMemoryPool::GetMemoryLastModifiedTime(const std::string& memory_id) const {
-    auto it = memory_last_modified_time.find(memory_id);
-    if (it != memory_last_modified_time.end()) {
-        return it->second;
-    }
-    return 0; // 返回0表示没有记录
+    const AllocationRecord* record = FindMemory(memory_id);
+    return record ? record->last_modified : 0; // 返回0表示没有记录
 }
 
 // 获取内存最后修改时间字符串
 std::string SharedMemoryPool::GetMemoryLastModifiedTimeString(const std::string& memory_id) const {
-    time_t timeValue = GetMemoryLastModifiedTime(memory_id);
+    return FormatModifiedTime(GetMemoryLastModifiedTime(memory_id));
+}
+
+// 格式化修改时间
+std::string SharedMemoryPool::FormatModifiedTime(time_t timeValue) {
     if (timeValue == 0) {
         return "N/A";
     }
 
-    std::tm* timeInfo = std::localtime(&timeValue);
-    if (timeInfo == nullptr) {
+    // 使用可重入版本，多个线程可以同时查询
+    std::tm timeInfo{};
+#ifdef _WIN32
+    if (localtime_s(&timeInfo, &timeValue) != 0) {
+        return "N/A";
+    }
+#else
+    if (localtime_r(&timeValue, &timeInfo) == nullptr) {
         return "N/A";
     }
+#endif
 
     std::ostringstream oss;
-    oss << std::put_time(timeInfo, "%Y-%m-%d %H:%M:%S");
+    oss << std::put_time(&timeInfo, "%Y-%m-%d %H:%M:%S");
     return oss.str();
 }
 
 // 获取内存内容字符串
 std::string SharedMemoryPool::GetMemoryContentAsString(const std::string& memory_id) const {
-    // 查找内存的块信息
-    auto it = memory_info.find(memory_id);
-    if (it == memory_info.end()) {
+    size_t length = 0;
+    const uint8_t* data = GetMemoryData(memory_id, length);
+    if (!data) {
         return ""; // 内存ID不存在
     }
+    return std::string(reinterpret_cast<const char*>(data), length);
+}
+
+// 获取内存内容的地址和字节数
+const uint8_t* SharedMemoryPool::GetMemoryData(const std::string& memory_id,
+                                               size_t& length) const {
+    const AllocationRecord* record = FindMemory(memory_id);
+    if (!record) {
+        return nullptr;
+    }
+    const uint8_t* data = pool_ + record->start_block * block_size_;
+    if (record->slab_slot >= 0) {
+        int sizeClass = slab_allocator_.GetSizeClass(record->start_block);
+        data += static_cast<size_t>(record->slab_slot) * slab_allocator_.SlotSize(sizeClass);
+    }
+    length = record->byte_length;
+    return data;
+}
+
+// 取得视图：记录下标和所在单元各计一次，紧凑和更新据此跳过
+bool SharedMemoryPool::AcquireView(const std::string& memory_id, MemoryView& view) {
+    if (segment_) {
+        return false; // 其他进程的紧凑看不到本进程的视图
+    }
+    uint32_t index = memory_index_.Find(memory_id);
+    if (index == MemoryIdIndex::npos) {
+        return false;
+    }
+    size_t length = 0;
+    const uint8_t* data = GetMemoryData(memory_id, length);
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    uint64_t lease = next_view_lease_++;
+    size_t unit = records_[index].start_block;
+    view_leases_[lease] = ViewLease{index, unit};
+    ++record_views_[index];
+    ++unit_views_[unit];
+    active_views_.fetch_add(1, std::memory_order_release);
+    view.data = data;
+    view.length = length;
+    view.lease = lease;
+    return true;
+}
+
+bool SharedMemoryPool::ReleaseView(uint64_t lease) {
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    auto it = view_leases_.find(lease);
+    if (it == view_leases_.end()) {
+        return false;
+    }
+    if (--record_views_[it->second.record] == 0) {
+        record_views_.erase(it->second.record);
+    }
+    if (--unit_views_[it->second.unit] == 0) {
+        unit_views_.erase(it->second.unit);
+    }
+    view_leases_.erase(it);
+    active_views_.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+size_t SharedMemoryPool::GetViewCount(const std::string& memory_id) const {
+    uint32_t index = memory_index_.Find(memory_id);
+    if (index == MemoryIdIndex::npos || active_views_.load(std::memory_order_acquire) == 0) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    auto it = record_views_.find(index);
+    return (it == record_views_.end()) ? 0 : it->second;
+}
+
+bool SharedMemoryPool::IsRecordPinned(uint32_t index) const {
+    if (active_views_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    return record_views_.count(index) != 0;
+}
+
+bool SharedMemoryPool::IsUnitPinned(size_t start) const {
+    if (block_owner_[start] == kReservedOwner) {
+        return true; // 调用方正在锁外写入
+    }
+    if (active_views_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(view_mutex_);
+    return unit_views_.count(start) != 0;
+}
+
+// 启用无锁读取：建立快照索引，解锁时发布所有记录
+bool SharedMemoryPool::EnableLockFreeReads() {
+    if (segment_) {
+        return false;
+    }
+    SharedLock lock(*this);
+    if (!read_index_) {
+        read_index_ = std::make_unique<ReadIndex>();
+        publish_all_ = true;
+    }
+    return true;
+}
 
-    size_t startBlock = it->second.first;
-    size_t blockCount = it->second.second;
-    size_t totalSize = blockCount * kBlockSize;
+// 把改动过的记录发布为新快照（在写锁内、写序号变回偶数之前调用）
+// 先删除编号已经变化的旧快照，再发布新快照：同一 ID 在一次写锁内换了记录槽位时
+// （例如 Update 改变 slab 大小级别），新快照不会被旧槽位的删除覆盖
+void SharedMemoryPool::PublishReadIndex() {
+    std::vector<uint32_t> indexes;
+    if (publish_all_) {
+        indexes.resize(std::max(records_.size(), read_index_->RecordSlots()));
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            indexes[i] = static_cast<uint32_t>(i);
+        }
+    } else {
+        indexes.swap(dirty_records_);
+        std::sort(indexes.begin(), indexes.end());
+        indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    }
+    dirty_records_.clear();
+    publish_all_ = false;
+
+    // 非标准格式的 ID 不放入索引（读取时走读锁）
+    auto numberOf = [this](uint32_t index) -> uint64_t {
+        uint64_t number = 0;
+        if (index >= records_.size() ||
+            !MemoryIdIndex::ParseId(records_[index].memory_id, number)) {
+            return 0;
+        }
+        return number;
+    };
+    for (uint32_t index : indexes) {
+        const ReadIndex::Entry* published = read_index_->Published(index);
+        if (published && published->number != numberOf(index)) {
+            read_index_->Publish(index, nullptr);
+        }
+    }
+    for (uint32_t index : indexes) {
+        uint64_t number = numberOf(index);
+        if (number == 0) {
+            continue;
+        }
+        const AllocationRecord& record = records_[index];
+        auto* entry = new ReadIndex::Entry();
+        entry->number = number;
+        entry->memory_id = record.memory_id;
+        entry->description = record.description;
+        entry->start_block = record.start_block;
+        entry->block_count = record.block_count;
+        entry->slab_slot = record.slab_slot;
+        entry->offset = record.start_block * block_size_;
+        if (record.slab_slot >= 0) {
+            entry->slot_size =
+                slab_allocator_.SlotSize(slab_allocator_.GetSizeClass(record.start_block));
+            entry->offset += static_cast<size_t>(record.slab_slot) * entry->slot_size;
+        }
+        entry->byte_length = record.byte_length;
+        entry->last_modified = record.last_modified;
+        read_index_->Publish(index, entry);
+    }
+}
 
-    // 直接从内存池读取，遇到0停止
-    const uint8_t* data = pool_ + startBlock * kBlockSize;
-    std::string result;
+// 一次无锁读取：记下写序号，查找快照并复制，之后写序号不变说明期间没有写操作
+// 复制内容时写者可能正在修改同一段内存，这样读到的数据会因写序号变化而丢弃（见 CopyRacyBytes）
+template <typename ReadFn>
+SharedMemoryPool::LockFreeRead
+SharedMemoryPool::TryLockFreeRead(const std::string& memory_id, ReadFn&& read) const {
+    uint64_t number = 0;
+    if (!read_index_ || !MemoryIdIndex::ParseId(memory_id, number) || number == 0) {
+        return LockFreeRead::kUnavailable;
+    }
+    // 本线程持有写锁（嵌套调用）时写序号一直是奇数，直接在锁内读取
+    if (lock_owner_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+        return LockFreeRead::kUnavailable;
+    }
+    EpochReclaimer::Guard guard;
+    if (!guard.Active()) {
+        return LockFreeRead::kUnavailable;
+    }
+    for (int attempt = 0; attempt < kLockFreeReadRetries; ++attempt) {
+        uint64_t seq = write_seq_.load(std::memory_order_acquire);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        const ReadIndex::Entry* entry = read_index_->Find(number);
+        if (entry) {
+            read(*entry);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (write_seq_.load(std::memory_order_relaxed) == seq) {
+            return entry ? LockFreeRead::kFound : LockFreeRead::kNotFound;
+        }
+    }
+    return LockFreeRead::kUnavailable;
+}
 
-    for (size_t i = 0; i < totalSize; ++i) {
-        if (data[i] == 0) {
-            break; // 遇到0，字符串结尾
+// 读取记录信息和内容
+bool SharedMemoryPool::ReadMemorySnapshot(const std::string& memory_id, MemorySnapshot& out,
+                                          bool withContent) {
+    LockFreeRead result = TryLockFreeRead(memory_id, [&](const ReadIndex::Entry& entry) {
+        out.memory_id = entry.memory_id;
+        out.description = entry.description;
+        out.start_block = entry.start_block;
+        out.block_count = entry.block_count;
+        out.slab_slot = entry.slab_slot;
+        out.slot_size = entry.slot_size;
+        out.byte_length = entry.byte_length;
+        out.last_modified = entry.last_modified;
+        if (withContent) {
+            out.content.resize(entry.byte_length);
+            CopyRacyBytes(&out.content[0], pool_ + entry.offset, entry.byte_length);
+        } else {
+            out.content.clear();
         }
-        result += static_cast<char>(data[i]);
+    });
+    if (result != LockFreeRead::kUnavailable) {
+        return result == LockFreeRead::kFound;
     }
 
-    return result;
+    SharedLock lock(*this, SharedLock::Mode::kRead);
+    const AllocationRecord* record = FindMemory(memory_id);
+    if (!record) {
+        return false;
+    }
+    out.memory_id = record->memory_id;
+    out.description = record->description;
+    out.start_block = record->start_block;
+    out.block_count = record->block_count;
+    out.slab_slot = record->slab_slot;
+    out.slot_size = 0;
+    if (record->slab_slot >= 0) {
+        out.slot_size = slab_allocator_.SlotSize(slab_allocator_.GetSizeClass(record->start_block));
+    }
+    out.byte_length = record->byte_length;
+    out.last_modified = record->last_modified;
+    out.content.clear();
+    if (withContent) {
+        size_t length = 0;
+        const uint8_t* data = GetMemoryData(memory_id, length);
+        out.content.assign(reinterpret_cast<const char*>(data), length);
+    }
+    return true;
+}
+
+// 把内容复制到调用方的缓冲区
+bool SharedMemoryPool::ReadMemory(const std::string& memory_id, void* buffer, size_t bufferSize,
+                                  size_t& length) {
+    LockFreeRead result = TryLockFreeRead(memory_id, [&](const ReadIndex::Entry& entry) {
+        length = entry.byte_length;
+        CopyRacyBytes(buffer, pool_ + entry.offset, std::min(length, bufferSize));
+    });
+    if (result != LockFreeRead::kUnavailable) {
+        return result == LockFreeRead::kFound;
+    }
+
+    SharedLock lock(*this, SharedLock::Mode::kRead);
+    const uint8_t* data = GetMemoryData(memory_id, length);
+    if (!data) {
+        return false;
+    }
+    std::memcpy(buffer, data, std::min(length, bufferSize));
+    return true;
 }
@@ -2,76 +2,310 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
-#include <bitset>
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
 #include <ctime>
-#include <cstdlib>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include "free_space_bitmap.h"
+#include "free_block_index.h"
+#include "slab_allocator.h"
+#include "memory_id_index.h"
+#include "read_index.h"
+#include "block_run_cache.h"
+#include "page_memory.h"
+#include "shared_segment.h"
+#include "background_compactor.h"
 
 class SharedMemoryPool {
   public:
-    static constexpr size_t kPoolSize = 1024 * 1024 * 1024;       // 1GB
-    static constexpr size_t kBlockSize = 4096;                    // 4KB
-    static constexpr size_t kBlockCount = kPoolSize / kBlockSize; // 512K块
+    static constexpr size_t kDefaultPoolSize = 1024 * 1024 * 1024; // 默认内存池大小 1GB
+    static constexpr size_t kDefaultBlockSize = 4096;              // 默认块大小 4KB
+    static constexpr size_t kMinBlockSize = 1024;                  // 最小块大小（须为 2 的幂）
+    static constexpr size_t kDefaultReleaseThreshold = 1024 * 1024; // 默认归还阈值 1MB
+    static constexpr size_t kDefaultCompactStepBytes = 256 * 1024;  // 增量紧凑每步移动量 256KB
+    static constexpr size_t kMaxCompactThreads = 8;                 // 完整紧凑的最大线程数
+    static constexpr size_t kCompactReleaseBytes = 2 * 1024 * 1024; // 紧凑后每步归还的尾部大小
+    static constexpr size_t kParallelCompactBytes = 4 * 1024 * 1024; // 一批移动达到该大小才并行
+    static constexpr size_t kCompactChunkBytes = 1024 * 1024;        // 并行复制时的分片大小
+    static constexpr int kLockFreeReadRetries = 8; // 无锁读取与写操作冲突时的重试次数
+    static constexpr size_t kRunCacheCount = 16;   // 区间缓存数量（线程按编号分开使用）
 
-    struct BlockMeta {
-        bool used = false;            // 是否被使用
-        std::string memory_id = "";   // 内存ID (memory_00001, memory_00002, ...)
+    // 块归属（block_owner_ 中的特殊值，其余值为分配记录下标）
+    static constexpr uint32_t kNoOwner = UINT32_MAX;       // 空闲块
+    static constexpr uint32_t kSlabOwner = UINT32_MAX - 1; // slab 块（由多个小对象共享）
+    static constexpr uint32_t kReservedOwner = UINT32_MAX - 2; // 预留块（尚未提交）
+
+    // 空闲块分配策略（Init 时选择）
+    enum class AllocationPolicy {
+        kNextFit, // 从上次分配位置开始在位图中顺序查找
+        kBestFit, // 空闲区间索引，选择长度足够的最小区间
+        kTlsf,    // 两级分离适配，查找/释放 O(1)
+    };
+
+    // 分配记录（每次分配一条，块只记录归属的记录下标）
+    struct AllocationRecord {
+        std::string memory_id = "";   // 内存ID（为空表示该记录槽位空闲）
         std::string description = ""; // 内容描述
+        size_t start_block = 0;       // 起始块（slab 小对象为所在的 slab 块）
+        size_t block_count = 0;       // 块数量（slab 小对象为 1）
+        size_t byte_length = 0;       // 数据字节数
+        time_t last_modified = 0;     // 最后修改时间
+        int32_t slab_slot = -1;       // slab 槽位编号（-1 表示整块分配）
     };
 
-    SharedMemoryPool() : pool_(nullptr), meta_(nullptr) {
+    SharedMemoryPool() : pool_(nullptr) {
     }
     ~SharedMemoryPool() {
+        StopBackgroundCompaction();
         if (pool_) {
-            std::free(pool_);
+            PageMemory::Unmap(pool_, pool_size_, backing_);
             pool_ = nullptr;
         }
-        if (meta_) {
-            // 调用每个 BlockMeta 的析构函数（因为包含 std::string）
-            for (size_t i = 0; i < kBlockCount; ++i) {
-                meta_[i].~BlockMeta();
-            }
-            std::free(meta_);
-            meta_ = nullptr;
-        }
     }
     // 禁止拷贝构造和赋值
     SharedMemoryPool(const SharedMemoryPool&) = delete;
     SharedMemoryPool& operator=(const SharedMemoryPool&) = delete;
 
-    bool Init();  // 分配内存池
-    void Reset(); // 清空所有块
+    // 使用大页作为内存池页面（在 Init 之前设置；大页不可用时自动退回普通页）
+    void SetHugePages(bool enable) {
+        huge_pages_ = enable;
+    }
+    PageMemory::Backing GetPageBacking() const {
+        return backing_;
+    }
+    // NUMA 放置（在 Init 之前设置）：节点号表示页面优先分配在该节点，
+    // NumaTopology::kInterleave 表示轮流分布到所有节点，默认 kAnyNode 不指定；单节点机器上忽略
+    void SetNumaNode(int node) {
+        numa_node_ = node;
+    }
+    int GetNumaNode() const {
+        return numa_node_;
+    }
+    bool Init(AllocationPolicy policy = AllocationPolicy::kBestFit); // 按默认大小分配内存池
+    // 按指定大小分配内存池（poolSize 向下取整为 blockSize 的整数倍，blockSize 须为 2 的幂）
+    bool Init(size_t poolSize, size_t blockSize,
+              AllocationPolicy policy = AllocationPolicy::kBestFit);
+    // 清空所有块；Init / InitShared / Reset 在仍有调用方持有内存池中的地址时
+    // （HasExternalReferences）不执行并返回 false
+    bool Reset();
+    // 有活动视图（持有者仍在读取内存池中的地址）或未提交的预留（生产者仍在锁外写入）
+    bool HasExternalReferences() const {
+        return active_views_.load(std::memory_order_acquire) > 0 || !reservations_.empty();
+    }
+
+    // 跨进程共享：打开（不存在时创建）命名共享段，内存池数据和分配记录表都位于段内
+    // 段已存在时使用段中的规格；recordCapacity 为 0 时等于块数量（记录表满时分配失败）
+    bool InitShared(const std::string& name, size_t poolSize, size_t blockSize,
+                    AllocationPolicy policy = AllocationPolicy::kBestFit,
+                    size_t recordCapacity = 0);
+    bool IsShared() const {
+        return segment_ != nullptr;
+    }
+
+    // 内存池操作锁（RAII）：多线程使用（后台紧凑、TCP 连接线程）时所有操作都要在锁内进行，
+    // 同一线程可以嵌套加锁；共享段内存池还会加跨进程锁，同步其他进程的修改，
+    // 解锁前发布本进程的修改
+    // kRead 模式只允许调用 const 查询（读取、状态、统计），多个线程可以同时持有；
+    // 共享段内存池加锁时要同步本地索引，kRead 按 kWrite 处理
+    // 持有读锁的线程不能再加写锁（会死锁），需要修改时先释放读锁
+    class SharedLock {
+      public:
+        enum class Mode { kWrite, kRead };
+        explicit SharedLock(SharedMemoryPool& pool, Mode mode = Mode::kWrite);
+        ~SharedLock();
+        SharedLock(const SharedLock&) = delete;
+        SharedLock& operator=(const SharedLock&) = delete;
+
+      private:
+        SharedMemoryPool& pool_;
+        bool locked_ = false;
+        bool read_locked_ = false;         // 持有的是读锁
+        SharedSegment* segment_ = nullptr; // 已加锁的共享段
+    };
 
-    // 元信息操作
-    const BlockMeta& GetMeta(size_t blockId) const;
-    bool SetMeta(size_t blockId, const std::string& memory_id, const std::string& description);
-    // 用于加载时直接设置元数据（不检查 used_map，不修改 free_block_count）
-    void SetMetaForLoad(size_t blockId, const std::string& memory_id,
-                        const std::string& description);
-    const std::map<std::string, std::pair<size_t, size_t>>& GetMemoryInfo() const;
+    // 后台紧凑：碎片率超过高水位时在后台线程中分步紧凑（每步持有 SharedLock）
+    // 停止时会等待后台线程退出，因此不能在持有 SharedLock 时调用 StopBackgroundCompaction
+    void StartBackgroundCompaction(const BackgroundCompactor::Settings& settings = {});
+    void StopBackgroundCompaction();
+    // 后台紧凑线程（未启动时返回 nullptr）
+    const BackgroundCompactor* GetBackgroundCompactor() const {
+        return compactor_.get();
+    }
+
+    // 内存池规格（Init 时确定）
+    size_t GetPoolSize() const {
+        return pool_size_;
+    }
+    size_t GetBlockSize() const {
+        return block_size_;
+    }
+    size_t GetBlockCount() const {
+        return block_count_;
+    }
+
+    // 分配记录查询
+    const AllocationRecord* FindMemory(const std::string& memory_id) const; // 不存在返回 nullptr
+    std::vector<const AllocationRecord*> GetAllocationsByStart() const; // 按起始块排序的所有记录
+    size_t GetAllocationCount() const {
+        return memory_index_.Size();
+    }
+    // 查询块的归属（kNoOwner / kSlabOwner / kReservedOwner / 记录下标）
+    uint32_t GetBlockOwner(size_t blockId) const {
+        return block_owner_[blockId];
+    }
+    const AllocationRecord& GetRecord(uint32_t index) const {
+        return records_[index];
+    }
+    // 获取内存描述
+    std::string GetMemoryDescription(const std::string& memory_id) const;
+    // 查询 slab 小对象所在槽位，普通（整块）内存返回 false
+    bool GetSlabSlot(const std::string& memory_id, size_t& slot, size_t& slotSize) const;
     // 获取内存最后修改时间
     time_t GetMemoryLastModifiedTime(const std::string& memory_id) const;
     std::string GetMemoryLastModifiedTimeString(const std::string& memory_id) const;
+    static std::string FormatModifiedTime(time_t timeValue); // 0 显示为 "N/A"
     // 生成下一个可用的 memory_id（O(1) 时间复杂度）
     std::string GenerateNextMemoryId() const;
-    // 初始化 Memory ID 计数器（从已存在的 memory_info 中找出最大值）
+    // 初始化 Memory ID 计数器（从已存在的分配记录中找出最大值）
     void InitializeMemoryIdCounter();
+    // Memory ID 编号序列：依次生成 first, first + stride, ...（多 arena 时按编号区分所属 arena）
+    void SetMemoryIdSequence(uint64_t first, uint64_t stride);
 
     // 内存分配相关
-    int FindContinuousFreeBlock(size_t blockCount); // 查找连续的空闲块
+    int FindContinuousFreeBlock(size_t blockCount); // 查找连续的空闲块（Next Fit）
+    int FindFreeBlock(size_t blockCount);           // 按当前分配策略查找连续的空闲块
     size_t GetMaxContinuousFreeBlocks() const;      // 获取最大连续空闲块数
-    void Compact();                                 // 紧凑内存
+    size_t GetFreeFragmentCount() const;            // 获取空闲碎片（空闲游程）数量
+    // 空闲区间统计（位图在分配/释放时增量维护，查询不扫描位图）
+    struct FragmentationStats {
+        size_t free_blocks = 0;      // 空闲块数
+        size_t fragment_count = 0;   // 空闲区间（碎片）数量
+        size_t largest_free_run = 0; // 最大连续空闲块数
+        // 第 i 项为长度在 [2^i, 2^(i+1)) 块之间的空闲区间数量（最后一项包含更长的区间）
+        FreeSpaceBitmap::RunHistogram run_histogram{};
+        size_t cached_blocks = 0; // 区间缓存中的块（计入 free_blocks，不属于任何空闲区间）
+    };
+    FragmentationStats GetFragmentationStats() const;
+    SlabAllocator::ClassStats GetSlabStats(int sizeClass) const; // 获取 slab 各级别使用情况
+    void Compact();                                 // 紧凑内存（归还尾部空闲区的物理页）
+    // 完整紧凑使用的线程数（0 表示按 CPU 核数，最多 kMaxCompactThreads）
+    void SetCompactThreads(size_t threads) {
+        compact_threads_ = threads;
+    }
+    // 增量紧凑：从上次停下的位置继续，把已使用的块逐个单元（一条分配记录或一个 slab 块）
+    // 向前移动，每个单元移动完后内存池都保持一致，两次调用之间可以正常分配/释放
+    // 移动字节数达到 maxBytes 或用完时间预算后返回（至少移动一个单元），
+    // 返回 true 表示本轮紧凑已完成（游标之后的已使用块全部位于前端）
+    bool CompactStep(size_t maxBytes = kDefaultCompactStepBytes);
+    bool CompactFor(std::chrono::microseconds budget);
     int AllocateBlock(const std::string& memory_id, const std::string& description,
                       const void* data, size_t dataSize); // 分配内存
+    // 更新内存内容：放得下时原地覆盖（多余的尾部块释放），后面紧邻的空闲块足够时原地扩展，
+    // 都不行时才搬到新位置（先取得新位置再释放原区间，描述不变）。返回内容所在的起始块，
+    // 参数无效（data 为空或 dataSize 为 0）、不存在或空间不足返回 -1
+    // （空间不足时原内容和记录保持不变；有活动视图时只允许原位覆盖）
+    int Update(const std::string& memory_id, const void* data, size_t dataSize);
 
     // 内存释放相关
-    bool FreeByMemoryId(const std::string& memory_id); // 释放指定内存ID的所有内存
-    bool FreeByBlockId(size_t blockId);                // 释放内存
-    void ClearBlockMeta(size_t blockId);               // 清理块的元数据（不更新 free_block_count）
+    // 释放指定内存ID的所有内存（不存在或有活动视图时返回 false）
+    bool FreeByMemoryId(const std::string& memory_id);
+    bool FreeByBlockId(size_t blockId);                // 释放块所属的整个分配（slab 块除外）
+
+    // 区间缓存：释放的 1 - 8 块区间先留在缓存中，之后分配相同块数时直接复用，
+    // 不查找也不更新位图和空闲区间索引。缓存属于内存池、在写锁内访问，按线程编号选择其中一个
+    // （同一线程释放和分配时复用自己刚释放的区间，多个线程可能共用一个缓存）；
+    // 按操作次数定期归还闲置的区间，查找失败、紧凑和归还物理页之前全部归还。共享段内存池不使用
+    size_t GetCachedBlockCount() const {
+        return cached_blocks_;
+    }
+    void FlushRunCaches(); // 把所有区间缓存中的区间归还为空闲区间
 
-    // 内存内容查询（直接从内存池读取）
+    // 物理内存归还（释放的连续区间不小于阈值时立即归还物理页，0 表示不归还）
+    size_t GetReleaseThreshold() const {
+        return release_threshold_;
+    }
+    void SetReleaseThreshold(size_t bytes) {
+        release_threshold_ = bytes;
+    }
+    size_t ReleaseFreeMemory(); // 归还所有空闲块的物理页，返回归还的字节数
+    // 常驻（已写入且未归还）字节数与逻辑（已分配块）字节数
+    size_t GetResidentBytes() const {
+        return resident_map_.CountUsed() * block_size_;
+    }
+    size_t GetLogicalBytes() const {
+        return (block_count_ - free_block_count) * block_size_;
+    }
+    // 常驻字节数按 NUMA 节点的分布（逐页查询实际所在节点；单节点或无法查询时只有一项）
+    std::vector<size_t> GetResidentBytesByNode() const;
+
+    // 内存内容查询（直接从内存池读取，按记录的字节数整体复制，内容中可以包含 0）
     std::string
-    GetMemoryContentAsString(const std::string& memory_id) const; // 获取内存内容字符串（遇到0停止）
+    GetMemoryContentAsString(const std::string& memory_id) const; // 获取内存内容（不存在返回空串）
+    // 内容在内存池中的起始地址和字节数（不存在返回 nullptr），指针在下次修改内存池前有效
+    const uint8_t* GetMemoryData(const std::string& memory_id, size_t& length) const;
+
+    // 视图（租约）：直接指向内存池中的内容，不复制。释放之前这条分配不会被紧凑（完整、增量、
+    // 定向）搬走，Update 只能原位覆盖（slab 级别或块数不变），FreeByMemoryId 返回 false。
+    // 同一分配可以同时有多个视图；Reset/加载后原有视图全部失效。共享段内存池不支持
+    struct MemoryView {
+        const uint8_t* data = nullptr;
+        size_t length = 0;  // 取得视图时内容的字节数
+        uint64_t lease = 0; // 租约编号（从 1 开始）
+    };
+    // 调用方须持有 SharedLock（读锁即可）；不存在或不支持时返回 false
+    bool AcquireView(const std::string& memory_id, MemoryView& view);
+    // 不需要持有 SharedLock；租约不存在（已释放或已失效）时返回 false
+    bool ReleaseView(uint64_t lease);
+    size_t GetViewCount(const std::string& memory_id) const; // 该分配的活动视图数
+    size_t GetActiveViewCount() const {
+        return active_views_.load(std::memory_order_acquire);
+    }
+
+    // 两阶段分配：Reserve 预留能放下 size 字节（含结尾 0）的整块区间，返回可以直接写入的地址，
+    // 调用方在锁外写入内容后 Commit 生成记录（多余的尾部块释放），或 Abort 归还区间。
+    // 提交之前没有 Memory ID，读者看不到；预留的区间不会被紧凑搬走。
+    // 三者都须持有 SharedLock（写锁）；有未提交的预留时 Reset / Init / 加载不执行。
+    // 共享段内存池不支持
+    bool Reserve(size_t size, const std::string& description, uint8_t*& data, uint64_t& ticket);
+    // 提交前 actualSize 字节（1 到预留的 size），返回起始块；票据不存在或大小不合法返回 -1
+    int Commit(uint64_t ticket, const std::string& memory_id, size_t actualSize);
+    bool CanCommit(uint64_t ticket, size_t actualSize) const; // 票据存在且 actualSize 合法
+    bool Abort(uint64_t ticket);
+    size_t GetReservationCount() const {
+        return reservations_.size();
+    }
+
+    // 无锁读取：启用后标准格式 ID 的读取不加内存池锁。读者在 epoch 临界区内查找只读的记录快照
+    // 并复制内容，期间有写锁则重试，重试 kLockFreeReadRetries 次或 ID 不是标准格式时退回读锁
+    // 启用后所有修改都必须在 SharedLock 内进行；共享段内存池不支持（返回 false）
+    bool EnableLockFreeReads();
+    bool IsLockFreeReadsEnabled() const {
+        return read_index_ != nullptr;
+    }
+    // 一次读取得到的记录信息和内容（相互一致）
+    struct MemorySnapshot {
+        std::string memory_id;
+        std::string description;
+        size_t start_block = 0;
+        size_t block_count = 0;
+        int slab_slot = -1;   // slab 槽位（-1 表示整块分配）
+        size_t slot_size = 0; // slab 槽位大小
+        size_t byte_length = 0;
+        time_t last_modified = 0;
+        std::string content; // withContent 为 false 时为空
+    };
+    // 读取记录信息和内容（不存在返回 false），自行加锁，调用方不需要持有 SharedLock
+    bool ReadMemorySnapshot(const std::string& memory_id, MemorySnapshot& out,
+                            bool withContent = true);
+    // 把内容复制到 buffer（最多 bufferSize 字节），length 返回内容的完整字节数（不存在返回 false）
+    bool ReadMemory(const std::string& memory_id, void* buffer, size_t bufferSize,
+                    size_t& length);
 
     // 持久化相关
     bool SaveToFile(const std::string& filename) const;                // 保存到文件
@@ -85,58 +319,178 @@ class SharedMemoryPool {
     uint8_t* GetPoolData() {
         return pool_;
     }
+    AllocationPolicy GetAllocationPolicy() const {
+        return policy_;
+    }
+    static const char* GetAllocationPolicyName(AllocationPolicy policy);
     size_t GetFreeBlockCount() const {
         return free_block_count;
     }
-    const std::bitset<kBlockCount>& GetUsedMap() const {
+    const FreeSpaceBitmap& GetUsedMap() const {
         return used_map;
     }
-    std::bitset<kBlockCount>& GetUsedMap() {
-        return used_map;
-    }
-    void SetFreeBlockCount(size_t count) {
-        free_block_count = count;
-    }
-    void SetMemoryInfo(const std::map<std::string, std::pair<size_t, size_t>>& info) {
-        memory_info = info;
-    }
     size_t GetNextSearchPos() const {
         return next_search_pos_;
     }
     void SetNextSearchPos(size_t pos) {
         next_search_pos_ = pos;
     }
-    void UpdateMemoryBlockCount(const std::string& memory_id, size_t newBlockCount);
-    // 获取和设置内存最后修改时间（供持久化使用）
-    const std::map<std::string, time_t>& GetMemoryLastModifiedTimeMap() const {
-        return memory_last_modified_time;
-    }
-    void SetMemoryLastModifiedTimeMap(const std::map<std::string, time_t>& timeMap) {
-        memory_last_modified_time = timeMap;
+    const SlabAllocator& GetSlabAllocator() const {
+        return slab_allocator_;
     }
+    // 加载时恢复分配记录和 slab（在 Reset 之后调用，同步更新位图、空闲索引和空闲块数量）
+    bool RestoreAllocation(const AllocationRecord& record);
+    bool RestoreSlab(size_t block, int sizeClass, uint64_t usedMask);
+    // 原地写入后调整分配大小（只支持缩小，释放尾部多余的块），同时更新最后修改时间
+    void UpdateMemorySize(const std::string& memory_id, size_t newBlockCount, size_t byteLength);
     // 更新指定内存ID的最后修改时间
-    void UpdateMemoryLastModifiedTime(const std::string& memory_id) {
-        memory_last_modified_time[memory_id] = std::time(nullptr);
-    }
+    void UpdateMemoryLastModifiedTime(const std::string& memory_id);
 
   private:
-    // 内存池（使用 malloc 分配）
-    uint8_t* pool_;   // 内存池数据
-    BlockMeta* meta_; // 块的元信息（使用 malloc 分配）
+    // 按内存池规格设置位图、块归属数组、slab 和空闲索引
+    void SetupMetadata(size_t blockCount, size_t blockSize, AllocationPolicy policy);
+    // 清空分配记录、位图和空闲索引（不修改内存池数据）
+    void ResetMetadata();
+    // 记录修改后待发布的槽位（共享段和无锁读取索引在解锁前发布），
+    // 从段内记录表重建本地索引，按段内变更日志只更新改动过的记录（日志不完整或与本地状态
+    // 冲突时返回 false，调用方改为完整重建），发布本进程的修改
+    void MarkRecordDirty(uint32_t index) {
+        if (segment_ || read_index_) {
+            dirty_records_.push_back(index);
+        }
+    }
+    bool HasRecordCapacity() const;
+    void SyncFromSegment();
+    bool ApplySegmentJournal();
+    void PublishToSegment();
+    // 无锁读取：把改动过的记录发布为新快照；尝试一次无锁读取（不可用或重试用完返回 kUnavailable）
+    void PublishReadIndex();
+    enum class LockFreeRead { kFound, kNotFound, kUnavailable };
+    template <typename ReadFn>
+    LockFreeRead TryLockFreeRead(const std::string& memory_id, ReadFn&& read) const;
+    // 标记块区间为已使用/空闲（同步 used_map 和空闲区间索引，不修改 free_block_count）
+    void MarkBlocksUsed(size_t start, size_t count);
+    void MarkBlocksFree(size_t start, size_t count);
+    size_t FreeRunHead(size_t start) const; // 空闲块所在空闲区间的首块
+    // 归还块区间内整页的物理内存，返回归还的常驻块数
+    size_t ReleaseBlocks(size_t start, size_t count);
+    // 释放块区间后按阈值决定是否归还物理页
+    void MaybeReleaseBlocks(size_t start, size_t count);
+    // 空闲区间中常驻的部分达到阈值时归还物理页（紧凑时使用）
+    bool ShouldReleaseResident(size_t start, size_t count) const;
+    // 分配/回收分配记录槽位
+    uint32_t NewRecord(const std::string& memory_id);
+    void ReleaseRecord(uint32_t index);
+    // 分配/释放 slab 小对象
+    int AllocateSlabObject(const std::string& memory_id, const std::string& description,
+                           const void* data, size_t dataSize, int sizeClass);
+    void FreeSlabObject(size_t block, size_t slot);
+    // 取得 sizeClass 级别的空闲槽位（没有未满的 slab 时取一个块作为新的 slab），空间不足返回 false
+    bool ClaimSlabSlot(int sizeClass, size_t& block, size_t& slot);
+    // 取得 blockCount 块的整块区间（先查区间缓存，再查找或紧凑），标记为已使用并从空闲块数中扣除，
+    // 块归属由调用方设置；空间不足返回 -1（紧凑可能搬动其他单元，调用方需要重新读取记录位置）
+    int ClaimRun(size_t blockCount);
+    // 区间缓存：按当前线程编号选择的缓存（共享段内存池返回 nullptr）；
+    // 放入已解除归属的区间（放不下返回 false），取出 count 块的区间，归还区间为空闲区间
+    BlockRunCache* SelectRunCache();
+    bool CacheFreedRun(size_t start, size_t count);
+    bool TakeCachedRun(size_t count, size_t& start);
+    void ReturnRuns(const std::vector<BlockRunCache::Run>& runs);
+    // 查找 blockCount 个连续空闲块，找不到时依次尝试定向紧凑和增量紧凑
+    int FindOrMakeFreeBlock(size_t blockCount);
+    // 把分配缩小到 newBlockCount 块，释放尾部多余的块
+    void ShrinkRecord(uint32_t index, size_t newBlockCount);
+    // 释放整块区间：解除归属，放入区间缓存或标记为空闲（不修改分配记录）
+    void FreeRun(size_t start, size_t count);
+    // 从 start 开始的单元（分配记录、slab 块或预留区间）的块数
+    size_t UnitBlockCount(size_t start) const;
+    static uint64_t SlabSlotKey(size_t block, size_t slot) {
+        return static_cast<uint64_t>(block) * SlabAllocator::kMaxSlotCount + slot;
+    }
+    // 增量紧凑：把游标之后第一个空洞后面的单元移动到空洞开头，累加移动的字节数
+    // 游标之后没有空洞时分步归还尾部常驻的物理页（每次一段），之后结束本轮（游标回到开头）
+    // 并返回 false
+    bool CompactNextUnit(size_t& movedBytes);
+    // 分配失败时增量紧凑，直到出现 blockCount 个连续空闲块，返回起始块（找不到返回 -1）
+    int CompactUntilFree(size_t blockCount);
+    // 定向紧凑：选出需要搬走的块数最少的 blockCount 块窗口，只把窗口中的分配搬到其他空闲区间，
+    // 返回窗口起始块（没有可行的窗口或搬迁失败时返回 -1）
+    int EvacuateWindow(size_t blockCount);
+    // 单元（分配记录或 slab 块）移动到 dst 后更新块归属和记录中的起始块（不修改位图和旧块归属）
+    void UpdateUnitLocation(size_t src, size_t dst, size_t count, uint32_t owner);
+    // 分配记录 / 单元（按起始块）是否有活动视图（预留区间的单元同样不能搬）
+    bool IsRecordPinned(uint32_t index) const;
+    bool IsUnitPinned(size_t start) const;
+
+    // 内存池（按页映射，页面首次写入时才占用物理内存）
+    uint8_t* pool_; // 内存池数据
+    bool huge_pages_ = false;                                   // 是否请求大页
+    int numa_node_ = NumaTopology::kAnyNode;                    // NUMA 放置策略
+    PageMemory::Backing backing_ = PageMemory::Backing::kStandard; // 实际使用的页面类型
+    // 内存池规格
+    size_t pool_size_ = 0;   // 内存池大小（字节）
+    size_t block_size_ = 0;  // 块大小（字节）
+    size_t block_count_ = 0; // 块数量
     // 记录空闲数据块信息
-    size_t free_block_count = kBlockCount; // 空闲块数量
-    std::bitset<kBlockCount> used_map;     // 记录块是否被使用
+    size_t free_block_count = 0; // 空闲块数量
+    FreeSpaceBitmap used_map;    // 记录块是否被使用（分层位图，按块数量动态分配）
+    AllocationPolicy policy_ = AllocationPolicy::kBestFit; // 分配策略
+    std::unique_ptr<FreeBlockIndex> free_index_; // 空闲块索引（Next Fit 策略下为空）
+    // 物理内存常驻情况（1 = 块已写入且尚未归还给操作系统）
+    FreeSpaceBitmap resident_map_;
+    size_t release_threshold_ = kDefaultReleaseThreshold; // 归还阈值（字节）
     // 记录内存使用情况
-    std::map<std::string, std::pair<size_t, size_t>> memory_info; // 内存ID -> (起始块位置, 块数量)
-    // 记录内存最后修改时间
-    std::map<std::string, time_t> memory_last_modified_time; // 内存ID -> 最后修改时间戳
-    // Memory ID 计数器（O(1) 生成 ID）
-    mutable uint64_t next_memory_id_counter_ =
-        1; // 下一个可用的 Memory ID 编号（使用 uint64_t 支持更大范围）
+    std::vector<AllocationRecord> records_;          // 分配记录（紧凑数组，槽位可复用）
+    std::vector<uint32_t> free_records_;             // 空闲的记录槽位
+    MemoryIdIndex memory_index_;                     // 内存ID -> 记录下标（按编号哈希）
+    std::vector<uint32_t> block_owner_;              // 块 -> 记录下标（每块 4 字节）
+    // 小对象 slab 层（数据加结尾 0 不超过半个块时与其他小对象共享块）
+    SlabAllocator slab_allocator_;
+    std::unordered_map<uint64_t, uint32_t> slab_slot_owner_; // (slab 块, 槽位) -> 记录下标
+    // 区间缓存（按线程编号选择，只在写锁内访问）和其中的总块数（计入 free_block_count）
+    std::vector<BlockRunCache> run_caches_;
+    size_t cached_blocks_ = 0;
+    // 视图租约：租约 -> (记录下标, 单元起始块)，以及按记录和单元统计的视图数
+    // 释放视图不持有内存池锁，这些成员都由 view_mutex_ 保护；没有视图时紧凑不加锁检查
+    struct ViewLease {
+        uint32_t record;
+        size_t unit;
+    };
+    mutable std::mutex view_mutex_;
+    std::unordered_map<uint64_t, ViewLease> view_leases_;
+    std::unordered_map<uint32_t, uint32_t> record_views_;
+    std::unordered_map<size_t, uint32_t> unit_views_;
+    uint64_t next_view_lease_ = 1;
+    std::atomic<size_t> active_views_{0};
+    // 两阶段分配：票据 -> 预留区间，以及预留区间起始块 -> 票据（紧凑时查块数）
+    struct Reservation {
+        size_t start;
+        size_t count;
+        size_t size; // 预留的字节数（提交的内容不能超过）
+        std::string description;
+    };
+    std::unordered_map<uint64_t, Reservation> reservations_;
+    std::unordered_map<size_t, uint64_t> reserved_starts_;
+    uint64_t next_ticket_ = 1;
+    size_t compact_cursor_ = 0; // 增量紧凑游标（本轮紧凑已处理到的位置）
+    size_t compact_threads_ = 0; // 完整紧凑使用的线程数（0 表示按 CPU 核数）
+    // 跨进程共享段（为空表示普通的进程内内存池）
+    std::unique_ptr<SharedSegment> segment_;
+    uint64_t segment_generation_ = 0;               // 本地索引对应的段元数据版本
+    uint64_t segment_journal_pos_ = 0;              // 本地索引已应用的变更日志位置
+    std::vector<uint32_t> dirty_records_;           // 待发布的记录槽位
+    bool publish_all_ = false;                      // 是否需要发布全部记录（重置/紧凑后）
+    std::shared_mutex op_mutex_;                    // 进程内的内存池操作锁（读写锁）
+    std::mutex write_gate_; // 写者排队时拦住新的读者（写优先，避免读请求密集时写者饿死）
+    // 无锁读取：快照索引（未启用时为空）和写序号（持有写锁期间为奇数，读者据此校验）
+    std::unique_ptr<ReadIndex> read_index_;
+    std::atomic<uint64_t> write_seq_{0};
+    std::atomic<std::thread::id> lock_owner_{};     // 持有操作锁的线程（用于嵌套加锁）
+    std::unique_ptr<BackgroundCompactor> compactor_; // 后台紧凑线程（未启动时为空）
+    // Memory ID 计数器（O(1) 生成 ID，原子递增，不在锁内调用也不会生成重复的 ID）
+    mutable std::atomic<uint64_t> next_memory_id_counter_{1}; // 下一个可用的 Memory ID 编号
+    uint64_t memory_id_first_ = 1;  // 编号序列的第一个值
+    uint64_t memory_id_stride_ = 1; // 编号序列的步长
     // 搜索起始位置（Next Fit 优化）
     size_t next_search_pos_ = 0; // 下次分配时开始搜索的位置，避免每次都从0开始
-
-    // Base62 编码辅助函数（用于生成更紧凑的 ID）
-    static std::string EncodeBase62(uint64_t num, size_t minLength = 5);
-    static uint64_t DecodeBase62(const std::string& str);
 };
@@ -0,0 +1,266 @@
+#include "shared_segment.h"
+#include "page_memory.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+size_t RoundUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// 等待创建者完成初始化（最多约 5 秒）
+bool WaitReady(const SharedSegment::Header* header) {
+    for (int i = 0; i < 5000; ++i) {
+        if (header->ready.load(std::memory_order_acquire) == 1) {
+            return header->magic == SharedSegment::kMagic &&
+                   header->version == SharedSegment::kVersion;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+} // namespace
+
+bool SharedSegment::Open(const std::string& name, size_t poolSize, size_t blockSize,
+                         size_t recordCapacity, bool& created) {
+    Close();
+    if (name.empty() || poolSize == 0 || blockSize == 0 || recordCapacity == 0) {
+        return false;
+    }
+    // 打开的段名已被最后一个进程删除时重新打开（此时会创建新段）
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        if (!OpenOnce(name, poolSize, blockSize, recordCapacity, created)) {
+            return false;
+        }
+        if (created) {
+            return true;
+        }
+        owner_died_ = Lock();
+        bool unlinked = header_->unlinked != 0;
+        if (!unlinked) {
+            header_->attach_count++;
+        }
+        Unlock();
+        if (!unlinked) {
+            return true;
+        }
+        Unmap();
+    }
+    return false;
+}
+
+bool SharedSegment::OpenOnce(const std::string& name, size_t poolSize, size_t blockSize,
+                             size_t recordCapacity, bool& created) {
+    // 计算段布局（内存池数据按页对齐）
+    size_t recordsOffset = RoundUp(sizeof(Header), 64);
+    size_t poolOffset =
+        RoundUp(recordsOffset + recordCapacity * sizeof(RecordEntry), PageMemory::PageSize());
+    size_t segmentSize = poolOffset + poolSize;
+
+#ifdef _WIN32
+    std::string mappingName = "Local\\" + name;
+    std::string mutexName = "Local\\" + name + "_lock";
+    HANDLE mutex = CreateMutexA(nullptr, FALSE, mutexName.c_str());
+    if (!mutex) {
+        return false;
+    }
+    HANDLE mapping =
+        CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                           static_cast<DWORD>(static_cast<uint64_t>(segmentSize) >> 32),
+                           static_cast<DWORD>(segmentSize & 0xFFFFFFFFu), mappingName.c_str());
+    if (!mapping) {
+        CloseHandle(mutex);
+        return false;
+    }
+    created = (GetLastError() != ERROR_ALREADY_EXISTS);
+    if (!created) {
+        // 先映射段头读取实际大小
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Header));
+        if (!view || !WaitReady(static_cast<Header*>(view))) {
+            if (view) {
+                UnmapViewOfFile(view);
+            }
+            CloseHandle(mapping);
+            CloseHandle(mutex);
+            return false;
+        }
+        segmentSize = static_cast<size_t>(static_cast<Header*>(view)->segment_size);
+        UnmapViewOfFile(view);
+    }
+    void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, segmentSize);
+    if (!base) {
+        CloseHandle(mapping);
+        CloseHandle(mutex);
+        return false;
+    }
+    mapping_ = mapping;
+    mutex_ = mutex;
+#else
+    std::string shmName = "/" + name;
+    int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    created = (fd >= 0);
+    if (created) {
+        if (ftruncate(fd, static_cast<off_t>(segmentSize)) != 0) {
+            close(fd);
+            shm_unlink(shmName.c_str());
+            return false;
+        }
+    } else {
+        if (errno != EEXIST) {
+            return false;
+        }
+        fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        // 等待创建者设置段大小并完成初始化
+        struct stat st {};
+        for (int i = 0; i < 5000 && fstat(fd, &st) == 0 &&
+                        static_cast<size_t>(st.st_size) < sizeof(Header);
+             ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        void* view = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        bool ready = WaitReady(static_cast<Header*>(view));
+        segmentSize = static_cast<size_t>(static_cast<Header*>(view)->segment_size);
+        munmap(view, sizeof(Header));
+        if (!ready) {
+            close(fd);
+            return false;
+        }
+    }
+    void* base = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        if (created) {
+            shm_unlink(shmName.c_str());
+        }
+        return false;
+    }
+    fd_ = fd;
+#endif
+
+    name_ = name;
+    base_ = static_cast<uint8_t*>(base);
+    header_ = reinterpret_cast<Header*>(base_);
+    mapped_size_ = segmentSize;
+
+    if (created) {
+        // 新段内容全部为 0，只需要填写段头
+        header_->magic = kMagic;
+        header_->version = kVersion;
+        header_->pool_size = poolSize;
+        header_->block_size = blockSize;
+        header_->record_capacity = recordCapacity;
+        header_->records_offset = recordsOffset;
+        header_->pool_offset = poolOffset;
+        header_->segment_size = segmentSize;
+        header_->generation = 1;
+        header_->record_count = 0;
+        header_->next_memory_id = 1;
+        header_->next_search_pos = 0;
+        header_->attach_count = 1;
+        header_->resync_generation = 1;
+        header_->journal_end = 0;
+#ifndef _WIN32
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header_->mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+#endif
+        header_->ready.store(1, std::memory_order_release);
+    }
+    return true;
+}
+
+void SharedSegment::Close() {
+    if (!base_) {
+        return;
+    }
+    // 其他进程仍连接时保留段名，否则之后打开同名段的进程会创建新段，与仍在使用的段分离
+    // （Windows 最后一个句柄关闭后系统自动删除段）；在锁内删除，正在打开的进程加锁后能看到
+    Lock();
+    if (header_->attach_count > 0) {
+        header_->attach_count--;
+    }
+#ifndef _WIN32
+    if (header_->attach_count == 0) {
+        header_->unlinked = 1;
+        shm_unlink(("/" + name_).c_str());
+    }
+#endif
+    Unlock();
+    Unmap();
+}
+
+void SharedSegment::Unmap() {
+#ifdef _WIN32
+    UnmapViewOfFile(base_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    CloseHandle(static_cast<HANDLE>(mutex_));
+    mapping_ = nullptr;
+    mutex_ = nullptr;
+#else
+    munmap(base_, mapped_size_);
+    close(fd_);
+    fd_ = -1;
+#endif
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_size_ = 0;
+    owner_died_ = false;
+    name_.clear();
+}
+
+bool SharedSegment::Lock() {
+#ifdef _WIN32
+    bool ownerDied =
+        WaitForSingleObject(static_cast<HANDLE>(mutex_), INFINITE) == WAIT_ABANDONED;
+#else
+    bool ownerDied = false;
+    if (pthread_mutex_lock(&header_->mutex) == EOWNERDEAD) {
+        pthread_mutex_consistent(&header_->mutex);
+        ownerDied = true;
+    }
+#endif
+    ownerDied = ownerDied || owner_died_;
+    owner_died_ = false;
+    return ownerDied;
+}
+
+void SharedSegment::Unlock() {
+#ifdef _WIN32
+    ReleaseMutex(static_cast<HANDLE>(mutex_));
+#else
+    pthread_mutex_unlock(&header_->mutex);
+#endif
+}
+
+std::string SharedSegment::FitDescription(const std::string& description) {
+    if (description.size() < kDescSize) {
+        return description;
+    }
+    size_t length = kDescSize - 1;
+    // 回退到 UTF-8 字符的起始字节
+    while (length > 0 && (static_cast<unsigned char>(description[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    return description.substr(0, length);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// 跨进程共享的内存池段（命名共享内存）
+//   Windows：CreateFileMapping（页面文件） + 命名互斥量
+//   其他平台：shm_open + 段内的进程共享健壮互斥量（PTHREAD_MUTEX_ROBUST）
+// 段布局：Header | 分配记录表（定长条目，下标与 SharedMemoryPool::records_ 一致）| 内存池数据
+// 分配记录表是元数据的唯一来源，各进程加锁后根据 generation 判断是否需要同步本地索引：
+// 段头的变更日志记录每次发布改动过的记录下标，落后不多的进程只按日志更新改动的记录，
+// 日志已被覆盖、重置或持锁进程异常退出后才从整个记录表重建
+// （位图、块归属、空闲索引和 slab 仍由各进程在本地维护，不在段内）
+// 段头记录连接的进程数，最后一个进程关闭时才删除段名（之后打开同名段会创建新段）
+class SharedSegment {
+  public:
+    static constexpr uint32_t kMagic = 0x53474D53; // "SMGS"
+    static constexpr uint32_t kVersion = 3;
+    static constexpr size_t kIdSize = 64;    // memory_id 最大长度（含结尾 0，与 SMM_MemoryInfo 一致）
+    static constexpr size_t kDescSize = 256; // description 最大长度（含结尾 0）
+    static constexpr size_t kJournalSize = 4096; // 变更日志条目数（环形）
+
+    // 分配记录条目
+    struct RecordEntry {
+        char memory_id[kIdSize];      // 为空表示槽位空闲
+        char description[kDescSize];  // 内容描述（超长时按 UTF-8 字符截断）
+        uint64_t start_block;         // 起始块
+        uint64_t block_count;         // 块数量
+        uint64_t byte_length;         // 数据字节数
+        int64_t last_modified;        // 最后修改时间
+        int32_t slab_slot;            // slab 槽位（-1 表示整块分配）
+        int32_t slab_class;           // slab 级别（整块分配为 -1）
+    };
+
+    // 段头（由创建者初始化，ready 置 1 之后其他进程才能使用）
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        std::atomic<uint32_t> ready;
+        uint32_t unlinked;        // 最后一个进程已关闭、段名已删除（持有段名的打开者需要重新打开）
+        uint64_t pool_size;       // 内存池大小（字节）
+        uint64_t block_size;      // 块大小（字节）
+        uint64_t record_capacity; // 分配记录表容量
+        uint64_t records_offset;  // 分配记录表在段内的偏移
+        uint64_t pool_offset;     // 内存池数据在段内的偏移
+        uint64_t segment_size;    // 段总大小
+        uint64_t generation;      // 元数据版本（每次修改后加 1）
+        uint64_t record_count;    // 记录表中已使用的最大下标 + 1
+        uint64_t next_memory_id;  // Memory ID 计数器（跨进程唯一）
+        uint64_t next_search_pos; // Next Fit 搜索起始位置
+        uint64_t attach_count;    // 连接的进程数（在锁内修改，异常退出的进程不会减少）
+        uint64_t resync_generation; // 发布全部记录时的 generation（更早的本地索引须完整重建）
+        uint64_t journal_end;       // 已写入变更日志的条目总数
+        uint32_t journal[kJournalSize]; // 变更日志：改动过的记录下标（按 journal_end 取模）
+#ifndef _WIN32
+        pthread_mutex_t mutex; // 进程共享的健壮互斥量
+#endif
+    };
+
+    SharedSegment() = default;
+    ~SharedSegment() {
+        Close();
+    }
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    // 打开（不存在时创建）命名段；已存在时使用段中的规格，忽略传入的大小
+    // created 返回本进程是否为创建者
+    bool Open(const std::string& name, size_t poolSize, size_t blockSize, size_t recordCapacity,
+              bool& created);
+    void Close(); // 解除映射，最后一个连接的进程同时删除段名
+
+    // 加锁/解锁（跨进程互斥），上一个持有者异常退出时 Lock 返回 true，元数据需要重建
+    // （在 Open / Close 内部加锁时发现的异常退出留到下一次 Lock 返回）
+    bool Lock();
+    void Unlock();
+
+    Header* GetHeader() const {
+        return header_;
+    }
+    RecordEntry* GetRecords() const {
+        return reinterpret_cast<RecordEntry*>(base_ + header_->records_offset);
+    }
+    uint8_t* GetPoolData() const {
+        return base_ + header_->pool_offset;
+    }
+    const std::string& GetName() const {
+        return name_;
+    }
+
+    // 按段内条目的长度截断描述（不截断半个 UTF-8 字符）
+    static std::string FitDescription(const std::string& description);
+
+  private:
+    // 打开或创建一次（不处理已删除的段名），解除映射（不修改连接数）
+    bool OpenOnce(const std::string& name, size_t poolSize, size_t blockSize,
+                  size_t recordCapacity, bool& created);
+    void Unmap();
+
+    std::string name_;
+    uint8_t* base_ = nullptr;
+    Header* header_ = nullptr;
+    size_t mapped_size_ = 0;
+    bool owner_died_ = false; // Open 加锁时发现上一个持有者异常退出
+#ifdef _WIN32
+    void* mapping_ = nullptr; // HANDLE
+    void* mutex_ = nullptr;   // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
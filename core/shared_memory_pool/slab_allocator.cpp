@@ -0,0 +1,145 @@
+#include "slab_allocator.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+// 位运算辅助函数（参数必须非 0）
+inline unsigned Ctz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned Popcount64(uint64_t x) {
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(x));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#endif
+}
+} // namespace
+
+int SlabAllocator::SizeClassFor(size_t bytes) const {
+    for (size_t cls = 0; cls < kClassCount; ++cls) {
+        if (bytes <= SlotSize(static_cast<int>(cls))) {
+            return static_cast<int>(cls);
+        }
+    }
+    return -1;
+}
+
+uint64_t SlabAllocator::FullMask(int sizeClass) const {
+    size_t slots = SlotsPerSlab(sizeClass);
+    return slots >= 64 ? ~0ULL : ((1ULL << slots) - 1);
+}
+
+bool SlabAllocator::AllocateSlot(int sizeClass, size_t& block, size_t& slot) {
+    auto& partial = partial_[sizeClass];
+    if (partial.empty()) {
+        return false;
+    }
+
+    // 优先使用地址最低的未满 slab，便于高地址的 slab 变空后归还
+    block = *partial.begin();
+    Slab& slab = slabs_[block];
+    uint64_t freeMask = ~slab.used_mask & FullMask(sizeClass);
+    slot = Ctz64(freeMask);
+    slab.used_mask |= 1ULL << slot;
+    if (slab.used_mask == FullMask(sizeClass)) {
+        partial.erase(partial.begin());
+    }
+    return true;
+}
+
+void SlabAllocator::AddSlab(size_t block, int sizeClass) {
+    Slab slab;
+    slab.size_class = static_cast<uint32_t>(sizeClass);
+    slabs_[block] = slab;
+    partial_[sizeClass].insert(block);
+}
+
+bool SlabAllocator::FreeSlot(size_t block, size_t slot) {
+    auto it = slabs_.find(block);
+    if (it == slabs_.end()) {
+        return false;
+    }
+    Slab& slab = it->second;
+    slab.used_mask &= ~(1ULL << slot);
+    if (slab.used_mask == 0) {
+        partial_[slab.size_class].erase(block);
+        slabs_.erase(it);
+        return true;
+    }
+    partial_[slab.size_class].insert(block);
+    return false;
+}
+
+int SlabAllocator::GetSizeClass(size_t block) const {
+    auto it = slabs_.find(block);
+    return it == slabs_.end() ? -1 : static_cast<int>(it->second.size_class);
+}
+
+void SlabAllocator::Move(size_t from, size_t to) {
+    auto it = slabs_.find(from);
+    if (it == slabs_.end() || from == to) {
+        return;
+    }
+    Slab slab = it->second;
+    slabs_.erase(it);
+    slabs_[to] = slab;
+
+    auto& partial = partial_[slab.size_class];
+    if (partial.erase(from)) {
+        partial.insert(to);
+    }
+}
+
+void SlabAllocator::Clear() {
+    slabs_.clear();
+    for (auto& partial : partial_) {
+        partial.clear();
+    }
+}
+
+SlabAllocator::ClassStats SlabAllocator::GetClassStats(int sizeClass) const {
+    ClassStats stats;
+    stats.slot_size = SlotSize(sizeClass);
+    for (const auto& entry : slabs_) {
+        if (static_cast<int>(entry.second.size_class) != sizeClass) {
+            continue;
+        }
+        stats.slab_count++;
+        stats.used_slots += Popcount64(entry.second.used_mask);
+    }
+    stats.total_slots = stats.slab_count * SlotsPerSlab(sizeClass);
+    return stats;
+}
+
+void SlabAllocator::RestoreSlab(size_t block, int sizeClass, uint64_t usedMask) {
+    Slab slab;
+    slab.size_class = static_cast<uint32_t>(sizeClass);
+    slab.used_mask = usedMask;
+    slabs_[block] = slab;
+    if (usedMask != FullMask(sizeClass)) {
+        partial_[sizeClass].insert(block);
+    }
+}
+
+void SlabAllocator::MarkSlotUsed(size_t block, size_t slot) {
+    Slab& slab = slabs_.at(block);
+    slab.used_mask |= 1ULL << slot;
+    if (slab.used_mask == FullMask(slab.size_class)) {
+        partial_[slab.size_class].erase(block);
+    }
+}
+
+bool SlabAllocator::IsSlotUsed(size_t block, size_t slot) const {
+    auto it = slabs_.find(block);
+    return it != slabs_.end() && (it->second.used_mask >> slot & 1) != 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <set>
+
+// 小对象 slab 分配器
+// 每个 slab 占用内存池中的一个块，按固定槽位大小（块大小的 1/64 - 1/2）切分，
+// 使用 64 位占用位图记录槽位使用情况（4KB 块时槽位为 64B - 2048B）
+// 这里只管理 slab 与槽位，块的分配/释放和数据读写由 SharedMemoryPool 负责
+class SlabAllocator {
+  public:
+    static constexpr size_t kClassCount = 6;   // 块大小的 1/64, 1/32, ..., 1/2
+    static constexpr size_t kMaxSlotCount = 64; // 每个 slab 的槽位数上限（占用位图位数）
+
+    struct Slab {
+        uint32_t size_class = 0; // 槽位大小级别
+        uint64_t used_mask = 0;  // 槽位占用位图
+    };
+
+    // 各级别统计信息（供 info 命令显示）
+    struct ClassStats {
+        size_t slot_size = 0;   // 槽位大小（字节）
+        size_t slab_count = 0;  // slab 数量
+        size_t used_slots = 0;  // 已使用槽位
+        size_t total_slots = 0; // 总槽位
+    };
+
+    explicit SlabAllocator(size_t blockSize = 4096) : min_slot_size_(blockSize / kMaxSlotCount) {
+    }
+
+    // 返回能容纳 bytes 字节的最小级别，超过最大槽位返回 -1
+    int SizeClassFor(size_t bytes) const;
+    size_t SlotSize(int sizeClass) const {
+        return min_slot_size_ << sizeClass;
+    }
+    size_t SlotsPerSlab(int sizeClass) const {
+        return kMaxSlotCount >> sizeClass;
+    }
+
+    // 从未满的 slab 中分配一个槽位，没有未满的 slab 时返回 false（需要调用 AddSlab）
+    bool AllocateSlot(int sizeClass, size_t& block, size_t& slot);
+    // 把一个空闲块登记为新的 slab
+    void AddSlab(size_t block, int sizeClass);
+    // 释放槽位，slab 变空时移除该 slab 并返回 true（调用者负责归还块）
+    bool FreeSlot(size_t block, size_t slot);
+
+    bool IsSlab(size_t block) const {
+        return slabs_.count(block) != 0;
+    }
+    int GetSizeClass(size_t block) const;
+    // 该级别是否还有未满的 slab（分配槽位不需要新块）
+    bool HasFreeSlot(int sizeClass) const {
+        return !partial_[sizeClass].empty();
+    }
+
+    // 紧凑时 slab 数据移动到新块后更新块号
+    void Move(size_t from, size_t to);
+    void Clear();
+
+    ClassStats GetClassStats(int sizeClass) const;
+
+    // 持久化辅助接口
+    const std::map<size_t, Slab>& GetSlabs() const {
+        return slabs_;
+    }
+    void RestoreSlab(size_t block, int sizeClass, uint64_t usedMask);
+    // 标记已有 slab 的槽位为已使用（共享段同步其他进程的分配）
+    void MarkSlotUsed(size_t block, size_t slot);
+    bool IsSlotUsed(size_t block, size_t slot) const;
+
+  private:
+    uint64_t FullMask(int sizeClass) const;
+
+    size_t min_slot_size_;
+    std::map<size_t, Slab> slabs_;          // 块号 -> slab
+    std::set<size_t> partial_[kClassCount]; // 各级别中未满的 slab（块号）
+};
@@ -0,0 +1,191 @@
+#include "tlsf_index.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+// 位运算辅助函数（参数必须非 0）
+inline unsigned Ctz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+inline unsigned Msb64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse64(&idx, x);
+    return static_cast<unsigned>(idx);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(x));
+#endif
+}
+} // namespace
+
+// 长度 -> (FL, SL)：长度小于 kSlCount 时一一对应到 FL 0
+void TlsfIndex::MappingInsert(size_t length, unsigned& fl, unsigned& sl) {
+    if (length < kSlCount) {
+        fl = 0;
+        sl = static_cast<unsigned>(length);
+        return;
+    }
+    unsigned msb = Msb64(length);
+    fl = msb - kSlLog2 + 1;
+    sl = static_cast<unsigned>(length >> (msb - kSlLog2)) - kSlCount;
+}
+
+// 查找时先向上取整到下一个子区间，保证该子区间中的任何空闲区间都足够大
+bool TlsfIndex::MappingSearch(size_t length, unsigned& fl, unsigned& sl) {
+    if (length >= kSlCount) {
+        size_t round = (size_t(1) << (Msb64(length) - kSlLog2)) - 1;
+        if (length + round < length) {
+            return false;
+        }
+        length += round;
+    }
+    MappingInsert(length, fl, sl);
+    return fl < kFlCount;
+}
+
+void TlsfIndex::Link(size_t head, size_t length) {
+    unsigned fl, sl;
+    MappingInsert(length, fl, sl);
+
+    uint32_t first = heads_[fl][sl];
+    next_[head] = first;
+    prev_[head] = kNil;
+    if (first != kNil) {
+        prev_[first] = static_cast<uint32_t>(head);
+    }
+    heads_[fl][sl] = static_cast<uint32_t>(head);
+    fl_bitmap_ |= 1ULL << fl;
+    sl_bitmap_[fl] |= 1u << sl;
+
+    run_len_[head] = static_cast<uint32_t>(length);
+    run_head_[head + length - 1] = static_cast<uint32_t>(head + 1);
+}
+
+void TlsfIndex::Unlink(size_t head) {
+    size_t length = run_len_[head];
+    unsigned fl, sl;
+    MappingInsert(length, fl, sl);
+
+    uint32_t next = next_[head];
+    uint32_t prev = prev_[head];
+    if (prev != kNil) {
+        next_[prev] = next;
+    } else {
+        heads_[fl][sl] = next;
+        if (next == kNil) {
+            sl_bitmap_[fl] &= ~(1u << sl);
+            if (sl_bitmap_[fl] == 0) {
+                fl_bitmap_ &= ~(1ULL << fl);
+            }
+        }
+    }
+    if (next != kNil) {
+        prev_[next] = prev;
+    }
+
+    run_len_[head] = 0;
+    run_head_[head + length - 1] = 0;
+}
+
+void TlsfIndex::Clear() {
+    // 只清理现存空闲区间的边界标记，代价与空闲区间数量成正比
+    while (fl_bitmap_) {
+        unsigned fl = Ctz64(fl_bitmap_);
+        unsigned sl = Ctz64(sl_bitmap_[fl]);
+        Unlink(heads_[fl][sl]);
+    }
+}
+
+void TlsfIndex::Reset(size_t blockCount) {
+    block_count_ = blockCount;
+    fl_bitmap_ = 0;
+    for (unsigned fl = 0; fl < kFlCount; ++fl) {
+        sl_bitmap_[fl] = 0;
+        for (unsigned sl = 0; sl < kSlCount; ++sl) {
+            heads_[fl][sl] = kNil;
+        }
+    }
+    next_.assign(blockCount, kNil);
+    prev_.assign(blockCount, kNil);
+    run_len_.assign(blockCount, 0);
+    run_head_.assign(blockCount, 0);
+    if (blockCount > 0) {
+        Link(0, blockCount);
+    }
+}
+
+void TlsfIndex::Insert(size_t start, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    // 与左侧空闲区间合并（左邻块是某个空闲区间的尾块）
+    if (start > 0 && run_head_[start - 1]) {
+        size_t leftHead = run_head_[start - 1] - 1;
+        size_t leftLen = run_len_[leftHead];
+        Unlink(leftHead);
+        start = leftHead;
+        length += leftLen;
+    }
+    // 与右侧空闲区间合并（右邻块是某个空闲区间的首块）
+    size_t end = start + length;
+    if (end < block_count_ && run_len_[end]) {
+        size_t rightLen = run_len_[end];
+        Unlink(end);
+        length += rightLen;
+    }
+    Link(start, length);
+}
+
+bool TlsfIndex::Remove(size_t head, size_t start, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    if (head >= block_count_ || start < head || !run_len_[head]) {
+        return false; // head 不是空闲区间的首块
+    }
+    size_t end = head + run_len_[head];
+    if (start + length > end) {
+        return false;
+    }
+
+    Unlink(head);
+    if (start > head) {
+        Link(head, start - head);
+    }
+    if (start + length < end) {
+        Link(start + length, end - (start + length));
+    }
+    return true;
+}
+
+size_t TlsfIndex::Find(size_t length) const {
+    if (length == 0 || length > block_count_) {
+        return npos;
+    }
+
+    unsigned fl, sl;
+    if (MappingSearch(length, fl, sl)) {
+        uint32_t slMap = sl_bitmap_[fl] & (~0u << sl);
+        if (!slMap) {
+            uint64_t flMap = (fl + 1 < 64) ? (fl_bitmap_ & (~0ULL << (fl + 1))) : 0;
+            if (flMap) {
+                fl = Ctz64(flMap);
+                slMap = sl_bitmap_[fl];
+            }
+        }
+        if (slMap) {
+            return heads_[fl][Ctz64(slMap)];
+        }
+    }
+    // 长度所在的子区间中可能有足够大的区间，但逐个检查与链表长度有关，不查找
+    return npos;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "free_block_index.h"
+#include <cstdint>
+#include <vector>
+
+// TLSF（Two-Level Segregated Fit）空闲块索引，以块为单位
+//   一级（FL）：按长度的最高位划分（2 的幂区间）
+//   二级（SL）：每个一级区间再线性划分为 2^kSlLog2 个子区间
+//   每个 (FL, SL) 对应一条空闲链表，fl_bitmap_ / sl_bitmap_ 记录哪些链表非空
+// 查找、插入和删除都只做固定次数的位运算，与空闲区间数量和长度无关
+// （查找只使用向上取整后的子区间，找不到时由调用方紧凑）；
+// 相邻空闲区间通过首尾块上的边界标记在 O(1) 内合并
+class TlsfIndex : public FreeBlockIndex {
+  public:
+    void Clear() override;
+    void Reset(size_t blockCount) override;
+    void Insert(size_t start, size_t length) override;
+    bool Remove(size_t head, size_t start, size_t length) override;
+    size_t Find(size_t length) const override;
+
+  private:
+    static constexpr unsigned kSlLog2 = 4;
+    static constexpr unsigned kSlCount = 1u << kSlLog2;
+    static constexpr unsigned kFlCount = 64 - kSlLog2;
+    static constexpr uint32_t kNil = static_cast<uint32_t>(-1);
+
+    static void MappingInsert(size_t length, unsigned& fl, unsigned& sl);
+    static bool MappingSearch(size_t length, unsigned& fl, unsigned& sl);
+
+    void Link(size_t head, size_t length);
+    void Unlink(size_t head);
+
+    size_t block_count_ = 0;
+    uint64_t fl_bitmap_ = 0;
+    uint32_t sl_bitmap_[kFlCount] = {};
+    uint32_t heads_[kFlCount][kSlCount];
+
+    // 以下数组按块编号索引
+    std::vector<uint32_t> next_;     // 空闲链表后继（仅区间首块有效）
+    std::vector<uint32_t> prev_;     // 空闲链表前驱（仅区间首块有效）
+    std::vector<uint32_t> run_len_;  // 区间首块：区间长度（0 表示不是空闲区间首块）
+    std::vector<uint32_t> run_head_; // 区间尾块：首块编号 + 1（0 表示不是空闲区间尾块）
+};
@@ -1,6 +1,6 @@
 @echo off
 cd /d %~dp0
-g++ main.cpp command/commands.cpp ../core/shared_memory_pool/shared_memory_pool.cpp ../core/persistence/persistence.cpp network/protocol.cpp network/tcp_server.cpp -o main.exe -lws2_32
+g++ main.cpp command/commands.cpp ../core/shared_memory_pool/shared_memory_pool.cpp ../core/shared_memory_pool/free_space_bitmap.cpp ../core/shared_memory_pool/free_extent_index.cpp ../core/shared_memory_pool/tlsf_index.cpp ../core/shared_memory_pool/slab_allocator.cpp ../core/shared_memory_pool/page_memory.cpp ../core/shared_memory_pool/shared_segment.cpp ../core/shared_memory_pool/background_compactor.cpp ../core/shared_memory_pool/memory_id_index.cpp ../core/shared_memory_pool/arena_pool.cpp ../core/shared_memory_pool/epoch_reclaimer.cpp ../core/shared_memory_pool/read_index.cpp ../core/shared_memory_pool/block_run_cache.cpp ../core/shared_memory_pool/numa_topology.cpp ../core/persistence/persistence.cpp network/protocol.cpp network/tcp_server.cpp -o main.exe -lws2_32
 if %errorlevel% equ 0 (
     echo Compilation successful!
 ) else (
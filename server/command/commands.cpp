@@ -8,8 +8,11 @@
 #include <cstring>
 #include <fstream>
 #include <climits>
+#include <cstdlib>
+#include <chrono>
 #include <vector>
 #include <filesystem>
+#include <optional>
 #include <windows.h>
 
 static const std::vector<CommandSpec> kCmds = {
@@ -55,7 +58,10 @@ static const std::vector<CommandSpec> kCmds = {
      {"update memory_00001 \"New Content\"", "update memory_00002 \"Updated\""}},
 
     // 紧凑命令
-    {"compact", "Compact memory pool (merge free blocks)", "compact", {"compact"}},
+    {"compact",
+     "Compact memory pool (merge free blocks), or run one time-budgeted incremental step",
+     "compact [--step [microseconds]]",
+     {"compact", "compact --step", "compact --step 500"}},
 
     // 执行文件命令
     {"exec",
@@ -134,7 +140,7 @@ static std::string ParseQuotedString(const std::vector<std::string>& tokens, siz
 // 读取文件内容（支持 .txt 文件）
 // filepath 可以是绝对路径（如 "C:\Users\file.txt"）或相对路径（如 "file.txt"）
 // 支持 UTF-8 编码的中文路径
-static bool ReadFileContent(const std::string& filepath, std::string& content) {
+static bool ReadFileContent(const std::string& filepath, std::string& content, size_t poolSize) {
     // 检查文件扩展名是否为 .txt
     if (filepath.length() < 4 || filepath.substr(filepath.length() - 4) != ".txt") {
         return false;
@@ -163,8 +169,8 @@ static bool ReadFileContent(const std::string& filepath, std::string& content) {
     file.seekg(0, std::ios::beg);
 
     // 检查文件大小是否超过内存池限制（预留一些空间）
-    constexpr size_t kMaxFileSize = SharedMemoryPool::kPoolSize - (1024 * 1024); // 预留1MB
-    if (fileSize > kMaxFileSize) {
+    constexpr size_t kReservedSize = 1024 * 1024; // 预留1MB
+    if (fileSize + kReservedSize > poolSize) {
         file.close();
         return false;
     }
@@ -322,6 +328,14 @@ void PrintHelpCommand(const std::string& cmd) {
 // 处理命令
 void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp) {
     const std::string& cmd = tokens[0];
+    // 整条命令在内存池锁内执行（exec 嵌套调用不会重复加锁）
+    // 只读命令加读锁，可以与 TCP 连接线程的读请求并行；read 使用无锁读取，不加锁
+    bool readOnly = cmd == "help" || cmd == "status" || cmd == "info";
+    std::optional<SharedMemoryPool::SharedLock> lock;
+    if (cmd != "read") {
+        lock.emplace(smp, readOnly ? SharedMemoryPool::SharedLock::Mode::kRead
+                                   : SharedMemoryPool::SharedLock::Mode::kWrite);
+    }
 
     // help 命令
     if (cmd == "help") {
@@ -350,37 +364,35 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
                          "-----------------------------|----------"
                          "-----------|\n";
 
-            // 使用指针避免复制数据，按起始 block 排序
-            const auto& memoryInfo = smp.GetMemoryInfo();
-            std::vector<const std::pair<const std::string, std::pair<size_t, size_t>>*>
-                sortedEntries;
-            sortedEntries.reserve(memoryInfo.size());
-            for (const auto& entry : memoryInfo) {
-                sortedEntries.push_back(&entry);
-            }
-            // 按照起始 block ID 排序
-            std::sort(sortedEntries.begin(), sortedEntries.end(), [](const auto* a, const auto* b) {
-                return a->second.first < b->second.first;
-            });
-
-            for (const auto* entry : sortedEntries) {
-                size_t blockCount = entry->second.second;
-                size_t totalBytes = blockCount * SharedMemoryPool::kBlockSize;
+            // 分配记录按起始 block 排序（只返回指针，不复制数据）
+            for (const auto* record : smp.GetAllocationsByStart()) {
+                size_t blockCount = record->block_count;
+                size_t totalBytes = blockCount * smp.GetBlockSize();
                 size_t totalKB = totalBytes / 1024;
 
                 std::ostringstream rangeStream;
-                rangeStream << "block_" << std::setfill('0') << std::setw(3) << entry->second.first
-                            << " - "
-                            << "block_" << std::setfill('0') << std::setw(3)
-                            << (entry->second.first + entry->second.second - 1) << "(" << blockCount
-                            << " blocks, " << totalKB << "KB)";
+                size_t slot = 0;
+                size_t slotSize = 0;
+                if (smp.GetSlabSlot(record->memory_id, slot, slotSize)) {
+                    // slab 小对象：显示所在块和槽位
+                    rangeStream << "block_" << std::setfill('0') << std::setw(3)
+                                << record->start_block << " slot " << slot << "(" << slotSize
+                                << "B slab)";
+                } else {
+                    rangeStream << "block_" << std::setfill('0') << std::setw(3)
+                                << record->start_block << " - "
+                                << "block_" << std::setfill('0') << std::setw(3)
+                                << (record->start_block + blockCount - 1) << "(" << blockCount
+                                << " blocks, " << totalKB << "KB)";
+                }
                 std::string rangeStr = rangeStream.str();
-                const auto& meta = smp.GetMeta(entry->second.first);
-                std::string description = meta.description.empty() ? "-" : meta.description;
+                std::string description = record->description;
+                if (description.empty()) {
+                    description = "-";
+                }
 
-                // 计算实际字节数（通过读取内容）
-                std::string content = smp.GetMemoryContentAsString(entry->first);
-                size_t bytes = content.size();
+                // 实际字节数（分配记录中保存）
+                size_t bytes = record->byte_length;
 
                 // 格式化字节数（添加千位分隔符）
                 std::ostringstream bytesStream;
@@ -388,13 +400,13 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
                 std::string bytesStr = bytesStream.str();
 
                 // 使用显示宽度进行截断和填充（支持中文）
-                std::string memoryId = PadToDisplayWidth(entry->first, 14);
+                std::string memoryId = PadToDisplayWidth(record->memory_id, 14);
                 description = TruncateToDisplayWidth(description, 17);
                 description = PadToDisplayWidth(description, 17);
                 std::string bytesFormatted = PadToDisplayWidth(bytesStr, 15);
                 std::string range = PadToDisplayWidth(rangeStr, 44);
                 std::string lastModified =
-                    PadToDisplayWidth(smp.GetMemoryLastModifiedTimeString(entry->first), 19);
+                    PadToDisplayWidth(smp.GetMemoryLastModifiedTimeString(record->memory_id), 19);
 
                 std::cout << "| " << memoryId << " | " << description << " | " << bytesFormatted
                           << " | " << range << " | " << lastModified << " |\n";
@@ -407,11 +419,11 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
             std::cout
                 << "|-----------|----------------|-------------------|---------------------|\n";
             bool hasUsedBlocks = false;
-            for (size_t i = 0; i < SharedMemoryPool::kBlockCount; i++) {
-                const auto& meta = smp.GetMeta(i);
+            for (size_t i = 0; i < smp.GetBlockCount(); i++) {
+                uint32_t owner = smp.GetBlockOwner(i);
 
                 // 只显示已使用的块，跳过空的块
-                if (!meta.used || meta.memory_id.empty()) {
+                if (owner == SharedMemoryPool::kNoOwner) {
                     continue;
                 }
 
@@ -420,16 +432,31 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
                 oss << "block_" << std::setfill('0') << std::setw(3) << i << std::setfill(' ');
 
                 std::string blockIdStr = oss.str();
-                std::string memoryId = meta.memory_id;
-                std::string description = meta.description.empty() ? "-" : meta.description;
+                // slab 块由多个小对象共享，没有单独的 memory_id
+                std::string memoryId = "-";
+                std::string description = "-";
+                std::string lastModifiedStr = "-";
+                if (owner == SharedMemoryPool::kSlabOwner) {
+                    int sizeClass = smp.GetSlabAllocator().GetSizeClass(i);
+                    description = "slab " +
+                                  std::to_string(smp.GetSlabAllocator().SlotSize(sizeClass)) + "B";
+                } else if (owner == SharedMemoryPool::kReservedOwner) {
+                    description = "reserved"; // 已预留、尚未提交
+                } else {
+                    const auto& record = smp.GetRecord(owner);
+                    memoryId = record.memory_id;
+                    if (!record.description.empty()) {
+                        description = record.description;
+                    }
+                    lastModifiedStr = smp.GetMemoryLastModifiedTimeString(record.memory_id);
+                }
 
                 // 使用显示宽度进行截断和填充（支持中文）
                 std::string blockId = PadToDisplayWidth(blockIdStr, 9);
                 memoryId = PadToDisplayWidth(memoryId, 14);
                 description = TruncateToDisplayWidth(description, 17);
                 description = PadToDisplayWidth(description, 17);
-                std::string lastModified =
-                    PadToDisplayWidth(smp.GetMemoryLastModifiedTimeString(meta.memory_id), 19);
+                std::string lastModified = PadToDisplayWidth(lastModifiedStr, 19);
 
                 std::cout << "| " << blockId << " | " << memoryId << " | " << description << " | "
                           << lastModified << " |\n";
@@ -458,23 +485,24 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
         std::cout << "[Memory Pool Configuration]\n";
         std::cout << "  +--------------------------------------------------------+\n";
         std::cout << "  | Total Size:     " << std::setw(10) << std::right
-                  << (SharedMemoryPool::kPoolSize / 1024) << " KB (" << SharedMemoryPool::kPoolSize
-                  << " bytes)\n";
+                  << (smp.GetPoolSize() / 1024) << " KB (" << smp.GetPoolSize() << " bytes)\n";
         std::cout << "  | Block Size:     " << std::setw(10) << std::right
-                  << (SharedMemoryPool::kBlockSize / 1024) << " KB ("
-                  << SharedMemoryPool::kBlockSize << " bytes)\n";
-        std::cout << "  | Total Blocks:   " << std::setw(10) << std::right
-                  << SharedMemoryPool::kBlockCount << " blocks\n";
+                  << (smp.GetBlockSize() / 1024) << " KB (" << smp.GetBlockSize() << " bytes)\n";
+        std::cout << "  | Total Blocks:   " << std::setw(10) << std::right << smp.GetBlockCount()
+                  << " blocks\n";
+        std::cout << "  | Alloc Policy:   "
+                  << SharedMemoryPool::GetAllocationPolicyName(smp.GetAllocationPolicy()) << "\n";
+        std::cout << "  | Page Backing:   " << PageMemory::GetBackingName(smp.GetPageBacking())
+                  << "\n";
         std::cout << "  +--------------------------------------------------------+\n";
         std::cout << "\n";
 
         // 2. 使用情况统计
-        size_t usedBlocks = SharedMemoryPool::kBlockCount - smp.GetFreeBlockCount();
+        size_t usedBlocks = smp.GetBlockCount() - smp.GetFreeBlockCount();
         size_t freeBlocks = smp.GetFreeBlockCount();
-        double usagePercent =
-            (static_cast<double>(usedBlocks) / SharedMemoryPool::kBlockCount) * 100.0;
-        size_t usedBytes = usedBlocks * SharedMemoryPool::kBlockSize;
-        size_t freeBytes = freeBlocks * SharedMemoryPool::kBlockSize;
+        double usagePercent = (static_cast<double>(usedBlocks) / smp.GetBlockCount()) * 100.0;
+        size_t usedBytes = usedBlocks * smp.GetBlockSize();
+        size_t freeBytes = freeBlocks * smp.GetBlockSize();
 
         std::cout << "[Usage Statistics]\n";
         std::cout << "  +--------------------------------------------------------+\n";
@@ -486,27 +514,38 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
                   << " blocks (" << std::setw(8) << std::right << (freeBytes / 1024) << " KB) ["
                   << std::fixed << std::setprecision(1) << std::setw(5) << std::right
                   << (100.0 - usagePercent) << "%]\n";
+        // 物理内存：常驻（已写入且未归还）与逻辑（已分配的块）
+        size_t residentBytes = smp.GetResidentBytes();
+        size_t logicalBytes = smp.GetLogicalBytes();
+        std::cout << "  | Resident:       " << std::setw(10) << std::right << (residentBytes / 1024)
+                  << " KB (logical " << (logicalBytes / 1024) << " KB)\n";
+        // 多 NUMA 节点时显示常驻物理页所在的节点（逐页查询，单节点时不显示）
+        if (NumaTopology::NodeCount() > 1) {
+            std::vector<size_t> nodeBytes = smp.GetResidentBytesByNode();
+            for (size_t node = 0; node < nodeBytes.size(); ++node) {
+                std::cout << "  |   Node " << std::setw(2) << std::left << node << "       "
+                          << std::setw(10) << std::right << (nodeBytes[node] / 1024)
+                          << " KB resident\n";
+            }
+        }
+        // 区间缓存中的块（计入空闲，复用前不属于任何空闲区间）
+        std::cout << "  | Run Cache:      " << std::setw(6) << std::right
+                  << smp.GetCachedBlockCount() << " blocks\n";
+        std::cout << "  | Release At:     ";
+        if (smp.GetReleaseThreshold() > 0) {
+            std::cout << std::setw(10) << std::right << (smp.GetReleaseThreshold() / 1024)
+                      << " KB free run\n";
+        } else {
+            std::cout << "  disabled\n";
+        }
         std::cout << "  +--------------------------------------------------------+\n";
         std::cout << "\n";
 
-        // 3. 内存分布信息
-        size_t maxContinuous = smp.GetMaxContinuousFreeBlocks();
-        size_t maxContinuousBytes = maxContinuous * SharedMemoryPool::kBlockSize;
-        const auto& usedMap = smp.GetUsedMap();
-
-        // 计算碎片化程度（空闲块片段数量）
-        size_t freeFragments = 0;
-        bool inFreeBlock = false;
-        for (size_t i = 0; i < SharedMemoryPool::kBlockCount; ++i) {
-            if (!usedMap[i]) {
-                if (!inFreeBlock) {
-                    freeFragments++;
-                    inFreeBlock = true;
-                }
-            } else {
-                inFreeBlock = false;
-            }
-        }
+        // 3. 内存分布信息（空闲区间统计随分配/释放增量维护，不扫描位图）
+        SharedMemoryPool::FragmentationStats frag = smp.GetFragmentationStats();
+        size_t maxContinuous = frag.largest_free_run;
+        size_t maxContinuousBytes = maxContinuous * smp.GetBlockSize();
+        size_t freeFragments = frag.fragment_count;
 
         std::cout << "[Memory Distribution]\n";
         std::cout << "  +--------------------------------------------------------+\n";
@@ -515,32 +554,87 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
                   << " KB)\n";
         std::cout << "  | Free Fragments: " << std::setw(6) << std::right << freeFragments
                   << " fragments\n";
+        // 空闲区间长度分布（按 2 的幂分桶，只显示非空的桶）
+        for (size_t i = 0; i < frag.run_histogram.size(); ++i) {
+            if (frag.run_histogram[i] == 0) {
+                continue;
+            }
+            std::string range = std::to_string(1ULL << i) + "-";
+            range += (i + 1 < frag.run_histogram.size()) ? std::to_string((2ULL << i) - 1) : "";
+            std::cout << "  |   " << std::setw(13) << std::left << range << std::setw(8)
+                      << std::right << frag.run_histogram[i] << " runs\n";
+        }
         if (freeFragments > 1) {
             std::cout << "  | Fragmentation:  Needs compact operation\n";
         } else {
             std::cout << "  | Fragmentation:  Memory is continuous, no compact needed\n";
         }
+        // 碎片率（1 - 最大连续空闲块 / 总空闲块）与后台紧凑状态
+        std::cout << "  | Frag Ratio:     " << std::setw(9) << std::right << std::fixed
+                  << std::setprecision(1) << BackgroundCompactor::GetFragmentation(smp) * 100.0
+                  << "%\n";
+        const BackgroundCompactor* compactor = smp.GetBackgroundCompactor();
+        std::cout << "  | Auto Compact:   ";
+        if (compactor != nullptr) {
+            const auto& settings = compactor->GetSettings();
+            auto stats = compactor->GetStats();
+            std::cout << "on (" << static_cast<int>(settings.high_watermark * 100) << "% -> "
+                      << static_cast<int>(settings.low_watermark * 100) << "%), " << stats.steps
+                      << " steps, " << stats.passes << " passes"
+                      << (stats.active ? ", running" : "") << "\n";
+        } else {
+            std::cout << "off\n";
+        }
+        std::cout << "  +--------------------------------------------------------+\n";
+        std::cout << "\n";
+
+        // 小对象 slab 使用情况
+        std::cout << "[Slab Allocator]\n";
+        std::cout << "  +--------------------------------------------------------+\n";
+        size_t slabUsedBytes = 0;
+        size_t slabTotalBytes = 0;
+        for (size_t cls = 0; cls < SlabAllocator::kClassCount; ++cls) {
+            auto stats = smp.GetSlabStats(static_cast<int>(cls));
+            if (stats.slab_count == 0) {
+                continue;
+            }
+            slabUsedBytes += stats.used_slots * stats.slot_size;
+            slabTotalBytes += stats.total_slots * stats.slot_size;
+            std::cout << "  | " << std::setw(4) << std::right << stats.slot_size
+                      << "B slots:    " << std::setw(6) << std::right << stats.slab_count
+                      << " slabs (" << std::setw(6) << std::right << stats.used_slots << " / "
+                      << std::setw(6) << std::left << stats.total_slots << std::right
+                      << " slots)\n";
+        }
+        if (slabTotalBytes == 0) {
+            std::cout << "  | No slabs in use\n";
+        } else {
+            std::cout << "  | Utilization:    " << std::fixed << std::setprecision(1)
+                      << std::setw(5) << std::right
+                      << (static_cast<double>(slabUsedBytes) / slabTotalBytes * 100.0)
+                      << "% of slab space\n";
+        }
         std::cout << "  +--------------------------------------------------------+\n";
         std::cout << "\n";
 
         // 4. 内存统计
-        const auto& memoryInfo = smp.GetMemoryInfo();
-        size_t memoryCount = memoryInfo.size();
+        const auto records = smp.GetAllocationsByStart();
+        size_t memoryCount = records.size();
         size_t totalMemoryBlocks = 0;
         size_t maxMemoryBlocks = 0;
         size_t minMemoryBlocks = (memoryCount > 0) ? static_cast<size_t>(-1) : 0;
         std::string maxMemoryId, minMemoryId;
 
-        for (const auto& entry : memoryInfo) {
-            size_t blockCount = entry.second.second;
+        for (const auto* record : records) {
+            size_t blockCount = record->block_count;
             totalMemoryBlocks += blockCount;
             if (blockCount > maxMemoryBlocks) {
                 maxMemoryBlocks = blockCount;
-                maxMemoryId = entry.first;
+                maxMemoryId = record->memory_id;
             }
             if (blockCount < minMemoryBlocks) {
                 minMemoryBlocks = blockCount;
-                minMemoryId = entry.first;
+                minMemoryId = record->memory_id;
             }
         }
 
@@ -702,7 +796,7 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
             std::string filepath = ExtractFilePath(content);
 
             // 读取文件内容（支持绝对路径和相对路径）
-            if (ReadFileContent(filepath, actualContent)) {
+            if (ReadFileContent(filepath, actualContent, smp.GetPoolSize())) {
                 isFileUpload = true;
                 std::cout << "Reading file: " << filepath << " (" << actualContent.size()
                           << " bytes)\n";
@@ -756,25 +850,24 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
             return;
         }
 
+        // 一次读取得到一致的记录信息和内容
         std::string memory_id = tokens[1];
-        std::string content = smp.GetMemoryContentAsString(memory_id);
-
-        if (content.empty()) {
-            std::cout << "Memory ID '" << memory_id << "' not found or content is empty.\n";
+        SharedMemoryPool::MemorySnapshot snapshot;
+        if (!smp.ReadMemorySnapshot(memory_id, snapshot)) {
+            std::cout << "Memory ID '" << memory_id << "' not found.\n";
             return;
         }
-
-        // 获取内存的块信息和描述
-        const auto& memoryInfo = smp.GetMemoryInfo();
-        auto it = memoryInfo.find(memory_id);
+        const std::string& content = snapshot.content;
 
         // 显示元信息
-        if (it != memoryInfo.end()) {
-            size_t startBlock = it->second.first;
-            size_t blockCount = it->second.second;
-            const auto& meta = smp.GetMeta(startBlock);
-            std::cout << "Memory ID: " << memory_id << "\n";
-            std::cout << "Description: " << meta.description << "\n";
+        size_t startBlock = snapshot.start_block;
+        size_t blockCount = snapshot.block_count;
+        std::cout << "Memory ID: " << memory_id << "\n";
+        std::cout << "Description: " << snapshot.description << "\n";
+        if (snapshot.slab_slot >= 0) {
+            std::cout << "Blocks: " << startBlock << " (slot " << snapshot.slab_slot << ", "
+                      << snapshot.slot_size << "B slab)\n";
+        } else {
             std::cout << "Blocks: " << startBlock << "-" << (startBlock + blockCount - 1) << "\n";
         }
 
@@ -794,10 +887,8 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
 
         // 显示大小和修改时间
         std::cout << "Size: " << content.size() << " bytes\n";
-        if (it != memoryInfo.end()) {
-            std::cout << "Last Modified: " << smp.GetMemoryLastModifiedTimeString(memory_id)
-                      << "\n";
-        }
+        std::cout << "Last Modified: "
+                  << SharedMemoryPool::FormatModifiedTime(snapshot.last_modified) << "\n";
         return;
     }
 
@@ -837,76 +928,22 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
         }
 
         // 检查内存ID是否存在
-        const auto& memoryInfo = smp.GetMemoryInfo();
-        auto it = memoryInfo.find(memory_id);
-        if (it == memoryInfo.end()) {
+        const auto* record = smp.FindMemory(memory_id);
+        if (!record) {
             std::cout << "Error: Memory ID '" << memory_id << "' not found.\n";
             std::cout << "Use 'alloc' command to allocate memory first.\n";
             return;
         }
 
-        // 获取内存当前的块信息和描述
-        size_t startBlock = it->second.first;
-        size_t currentBlockCount = it->second.second;
-        size_t currentSize = currentBlockCount * SharedMemoryPool::kBlockSize;
-        const auto& meta = smp.GetMeta(startBlock);
-        std::string description = meta.description;
-
-        // 计算新内容需要的块数
-        size_t newSize = newContent.size();
-        size_t requiredBlockCount =
-            (newSize + SharedMemoryPool::kBlockSize - 1) / SharedMemoryPool::kBlockSize;
-
-        // 如果新内容大小超过原分配，需要重新分配
-        if (newSize > currentSize) {
-            // 先释放原内存
-            smp.FreeByMemoryId(memory_id);
-            // 重新分配（保持相同的 memory_id 和 description）
-            int blockId = smp.AllocateBlock(memory_id, description, newContent.data(), newSize);
-            if (blockId >= 0) {
-                std::cout << "Content updated successfully. New content stored at block " << blockId
-                          << "\n";
-            } else {
-                std::cout << "Update failed. Insufficient memory for new content.\n";
-            }
+        // 放得下时原地覆盖，后面紧邻的空闲块足够时原地扩展，否则搬到新位置
+        size_t oldStartBlock = record->start_block;
+        int blockId = smp.Update(memory_id, newContent.data(), newContent.size());
+        if (blockId < 0) {
+            std::cout << "Update failed. Insufficient memory for new content.\n";
+        } else if (static_cast<size_t>(blockId) != oldStartBlock) {
+            std::cout << "Content updated successfully. New content stored at block " << blockId
+                      << "\n";
         } else {
-            // 新内容大小不超过原分配，直接覆盖写入
-            uint8_t* poolData = smp.GetPoolData();
-            size_t bytesWritten = 0;
-            // 只写入需要的块数，而不是所有 currentBlockCount 块
-            for (size_t i = 0; i < requiredBlockCount; ++i) {
-                size_t blockId = startBlock + i;
-                size_t bytesToWrite =
-                    std::min(SharedMemoryPool::kBlockSize, newSize - bytesWritten);
-
-                // 写入新数据
-                std::memcpy(poolData + blockId * SharedMemoryPool::kBlockSize,
-                            newContent.data() + bytesWritten, bytesToWrite);
-
-                // 如果块没有写满，剩余部分清零
-                if (bytesToWrite < SharedMemoryPool::kBlockSize) {
-                    std::memset(poolData + blockId * SharedMemoryPool::kBlockSize + bytesToWrite, 0,
-                                SharedMemoryPool::kBlockSize - bytesToWrite);
-                }
-
-                bytesWritten += bytesToWrite;
-            }
-
-            // 如果新内容需要的块数少于原分配，释放后续不需要的块
-            if (requiredBlockCount < currentBlockCount) {
-                // 先更新内存块信息中的块数量和 free_block_count
-                smp.UpdateMemoryBlockCount(memory_id, requiredBlockCount);
-                // 然后清理后续块的元数据和位图（不更新 free_block_count，因为已经通过
-                // UpdateMemoryBlockCount 更新了）
-                for (size_t i = requiredBlockCount; i < currentBlockCount; ++i) {
-                    size_t blockId = startBlock + i;
-                    smp.ClearBlockMeta(blockId);
-                }
-            }
-
-            // 更新最后修改时间
-            smp.UpdateMemoryLastModifiedTime(memory_id);
-
             std::cout << "Content updated successfully.\n";
         }
         return;
@@ -914,6 +951,27 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
 
     // compact 命令
     else if (cmd == "compact") {
+        // 增量紧凑：在时间预算（默认 200 微秒）内移动一部分分配，可以多次执行直到完成
+        if (tokens.size() >= 2 && tokens[1] == "--step") {
+            long long budget = 200;
+            if (tokens.size() >= 3) {
+                budget = std::atoll(tokens[2].c_str());
+                if (budget <= 0) {
+                    std::cout << "Usage: compact [--step [microseconds]]\n";
+                    return;
+                }
+            }
+            size_t fragmentsBefore = smp.GetFreeFragmentCount();
+            bool finished = smp.CompactFor(std::chrono::microseconds(budget));
+            std::cout << "Free fragments: " << fragmentsBefore << " -> "
+                      << smp.GetFreeFragmentCount() << "\n";
+            if (finished) {
+                std::cout << "Incremental compaction finished\n";
+            } else {
+                std::cout << "Incremental compaction in progress (run again to continue)\n";
+            }
+            return;
+        }
         std::cout << "Compacting memory pool...\n";
         smp.Compact();
         std::cout << "Memory pool compacted\n";
@@ -985,7 +1043,11 @@ void HandleCommand(const std::vector<std::string>& tokens, SharedMemoryPool& smp
         }
 
         if (password == "confirm_reset") {
-            smp.Reset();
+            if (!smp.Reset()) {
+                std::cout << "Error: Memory pool is in use (active views or reservations). "
+                             "Reset cancelled.\n";
+                return;
+            }
             std::cout << "Memory pool has been reset to default state.\n";
         } else {
             std::cout << "Invalid password. Reset cancelled.\n";
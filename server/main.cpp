@@ -31,6 +31,7 @@ void SignalHandler(int signal) {
     }
     if (g_smp != nullptr) {
         std::cerr << "Saving data...\n";
+        SharedMemoryPool::SharedLock lock(*g_smp);
         if (Persistence::Save(*g_smp)) {
             std::cerr << "Data saved successfully.\n";
         } else {
@@ -220,7 +221,7 @@ static void PrintServerConnectionInfo(uint16_t port) {
     std::cout << "\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     // 设置控制台代码页为 UTF-8，以支持中文显示
     SetConsoleOutputCP(65001); // UTF-8 code page
     SetConsoleCP(65001);       // UTF-8 code page
@@ -237,18 +238,77 @@ int main() {
     std::signal(SIGTERM, SignalHandler);
     std::signal(SIGBREAK, SignalHandler);
 
+    // 解析内存池规格参数：--pool-size <MB> --block-size <KB> --release-threshold <KB>
+    // --huge-pages --shared <name> --no-numa
+    // 后台紧凑水位（碎片率百分比，高水位为 0 时关闭后台紧凑）：--compact-high <%> --compact-low <%>
+    size_t poolSize = SharedMemoryPool::kDefaultPoolSize;
+    size_t blockSize = SharedMemoryPool::kDefaultBlockSize;
+    size_t releaseThreshold = SharedMemoryPool::kDefaultReleaseThreshold;
+    bool hugePages = false;
+    bool numaAware = true;
+    std::string sharedName;
+    BackgroundCompactor::Settings compactSettings;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--huge-pages") == 0) {
+            hugePages = true;
+        } else if (std::strcmp(argv[i], "--no-numa") == 0) {
+            numaAware = false;
+        } else if (hasValue && std::strcmp(argv[i], "--shared") == 0) {
+            sharedName = argv[++i];
+        } else if (hasValue && std::strcmp(argv[i], "--compact-high") == 0) {
+            compactSettings.high_watermark = std::strtod(argv[++i], nullptr) / 100.0;
+        } else if (hasValue && std::strcmp(argv[i], "--compact-low") == 0) {
+            compactSettings.low_watermark = std::strtod(argv[++i], nullptr) / 100.0;
+        } else if (hasValue && std::strcmp(argv[i], "--pool-size") == 0) {
+            poolSize = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) * 1024 * 1024;
+        } else if (hasValue && std::strcmp(argv[i], "--block-size") == 0) {
+            blockSize = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) * 1024;
+        } else if (hasValue && std::strcmp(argv[i], "--release-threshold") == 0) {
+            releaseThreshold = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) * 1024;
+        }
+    }
+
     // 先初始化内存池（分配内存空间）
-    if (!smp.Init()) {
-        std::cerr << "Failed to initialize SharedMemoryPool.\n";
+    smp.SetHugePages(hugePages);
+    // 多 NUMA 节点：所有连接线程共用一个内存池，页面轮流分布到各节点，
+    // 避免整个内存池落在首次写入的节点上、其他节点的线程全部远程访问
+    numaAware = numaAware && NumaTopology::NodeCount() > 1;
+    if (numaAware) {
+        smp.SetNumaNode(NumaTopology::kInterleave);
+    }
+    bool initialized = sharedName.empty() ? smp.Init(poolSize, blockSize)
+                                          : smp.InitShared(sharedName, poolSize, blockSize);
+    if (!initialized) {
+        std::cerr << "Failed to initialize SharedMemoryPool (pool size " << poolSize
+                  << " bytes, block size " << blockSize << " bytes).\n";
         std::cerr.flush();
         return 1;
     }
+    smp.SetReleaseThreshold(releaseThreshold);
+    if (numaAware) {
+        std::cout << "NUMA: " << NumaTopology::NodeCount()
+                  << " nodes, pool pages interleaved, connection threads pinned per node\n";
+    }
 
-    // 尝试加载之前保存的数据
-    if (Persistence::Load(smp)) {
-        std::cout << "Loaded previous state from " << Persistence::kDefaultFile << "\n";
-    } else {
-        std::cout << "Initialized new memory pool.\n";
+    // 尝试加载之前保存的数据（共享段中已有其他进程的数据时直接使用）
+    {
+        SharedMemoryPool::SharedLock lock(smp);
+        if (smp.GetAllocationCount() > 0) {
+            std::cout << "Attached to shared segment " << sharedName << "\n";
+        } else if (Persistence::Load(smp)) {
+            std::cout << "Loaded previous state from " << Persistence::kDefaultFile << "\n";
+        } else {
+            std::cout << "Initialized new memory pool.\n";
+        }
+    }
+
+    // 读取不加锁（共享段模式下不可用，读取仍然加锁）
+    smp.EnableLockFreeReads();
+
+    // 启动后台紧凑线程（碎片率超过高水位时在后台分步紧凑，前台分配基本不再触发紧凑）
+    if (compactSettings.high_watermark > 0) {
+        smp.StartBackgroundCompaction(compactSettings);
     }
 
     // 显示服务器连接信息（默认端口8888）
@@ -257,6 +317,7 @@ int main() {
 
     // 创建并启动 TCP 服务器（在后台线程中运行）
     TCPServer tcpServer(smp, kDefaultPort);
+    tcpServer.SetWorkerNodePinning(numaAware);
     g_tcp_server = &tcpServer;
 
     std::thread tcpServerThread([&tcpServer]() {
@@ -291,6 +352,7 @@ int main() {
             } else if (std::cin.fail()) {
                 std::cerr << "\nInput stream error, saving data...\n";
             }
+            SharedMemoryPool::SharedLock lock(smp);
             if (Persistence::Save(smp)) {
                 std::cerr << "Data saved successfully.\n";
             } else {
@@ -310,6 +372,7 @@ int main() {
                 g_tcp_server->Stop();
             }
             std::cout << "Saving data...\n";
+            SharedMemoryPool::SharedLock lock(smp);
             if (Persistence::Save(smp)) {
                 std::cout << "Data saved successfully.\n";
             } else {
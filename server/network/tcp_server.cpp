@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <vector>
+#include <optional>
 
 typedef int socklen_t;
 #define close closesocket
@@ -157,9 +158,13 @@ bool TCPServer::Start() {
 
         std::cout << "Client connected: " << clientInfo << "\n";
 
-        // 为每个客户端创建处理线程
+        // 为每个客户端创建处理线程（多 NUMA 节点时轮流固定到各节点）
+        size_t node = pinWorkers_ ? nextWorkerNode_++ % NumaTopology::NodeCount() : 0;
         std::lock_guard<std::mutex> lock(threadsMutex_);
-        clientThreads_.emplace_back([this, clientSocket, clientIP, clientPort]() {
+        clientThreads_.emplace_back([this, clientSocket, clientIP, clientPort, node]() {
+            if (pinWorkers_) {
+                NumaTopology::PinThreadToNode(node);
+            }
             HandleClient(clientSocket, clientIP, clientPort);
         });
     }
@@ -265,6 +270,14 @@ void TCPServer::ProcessRequest(SOCKET clientSocket, const Protocol::Request& req
                                Protocol::Response& resp) {
     resp.code = Protocol::ResponseCode::SUCCESS;
     resp.data.clear();
+    // 每个请求在内存池锁内处理：STATUS 加读锁，多个连接可以并行查询；
+    // READ 使用无锁读取，不加锁
+    std::optional<SharedMemoryPool::SharedLock> lock;
+    if (req.cmd == Protocol::CommandType::STATUS) {
+        lock.emplace(smp_, SharedMemoryPool::SharedLock::Mode::kRead);
+    } else if (req.cmd != Protocol::CommandType::READ) {
+        lock.emplace(smp_);
+    }
 
     try {
         switch (req.cmd) {
@@ -330,40 +343,30 @@ void TCPServer::ProcessRequest(SOCKET clientSocket, const Protocol::Request& req
             std::string memory_id = req.data.substr(0, nullPos);
             std::string newContent = req.data.substr(nullPos + 1);
 
+            if (newContent.empty()) {
+                resp.code = Protocol::ResponseCode::ERROR_INVALID_PARAM;
+                resp.data = "Empty content";
+                break;
+            }
+
             // 检查 Memory ID 是否存在
-            const auto& memoryInfo = smp_.GetMemoryInfo();
-            if (memoryInfo.find(memory_id) == memoryInfo.end()) {
+            const auto* record = smp_.FindMemory(memory_id);
+            if (!record) {
                 resp.code = Protocol::ResponseCode::ERROR_NOT_FOUND;
                 resp.data = "Error: Memory ID '" + memory_id +
                             "' not found.\nUse 'alloc' command to allocate memory first.\n";
                 break;
             }
 
-            // 获取当前描述和块信息（在释放前保存）
-            auto it = memoryInfo.find(memory_id);
-            size_t startBlock = it->second.first;
-            size_t currentBlockCount = it->second.second;
-            size_t currentSize = currentBlockCount * SharedMemoryPool::kBlockSize;
-            const auto& meta = smp_.GetMeta(startBlock);
-            std::string description = meta.description;
-
-            // 释放旧内存
-            smp_.FreeByMemoryId(memory_id);
-
-            // 计算新内容需要的块数
-            size_t newSize = newContent.size();
-            size_t requiredBlockCount =
-                (newSize + SharedMemoryPool::kBlockSize - 1) / SharedMemoryPool::kBlockSize;
-
-            // 分配新内存
-            int blockID =
-                smp_.AllocateBlock(memory_id, description, newContent.data(), newContent.size());
+            // 原地覆盖/原地扩展，都不行时才搬到新位置（空间不足时原内容保持不变）
+            size_t oldStartBlock = record->start_block;
+            int blockID = smp_.Update(memory_id, newContent.data(), newContent.size());
             if (blockID < 0) {
                 resp.code = Protocol::ResponseCode::ERROR_NO_MEMORY;
                 resp.data = "Update failed. Insufficient memory for new content.\n";
             } else {
                 std::ostringstream oss;
-                if (newSize > currentSize) {
+                if (static_cast<size_t>(blockID) != oldStartBlock) {
                     oss << "Content updated successfully. New content stored at block " << blockID
                         << "\n";
                 } else {
@@ -401,43 +404,43 @@ void TCPServer::ProcessRequest(SOCKET clientSocket, const Protocol::Request& req
             }
 
             std::string memory_id = req.data;
-            std::string content = smp_.GetMemoryContentAsString(memory_id);
-            if (content.empty()) {
+            SharedMemoryPool::MemorySnapshot snapshot;
+            if (!smp_.ReadMemorySnapshot(memory_id, snapshot)) {
                 resp.code = Protocol::ResponseCode::ERROR_NOT_FOUND;
-                resp.data = "Memory ID '" + memory_id + "' not found or content is empty.\n";
+                resp.data = "Memory ID '" + memory_id + "' not found.\n";
             } else {
                 // 返回格式化的内容信息（与 commands.cpp 格式一致）
-                const auto& memoryInfo = smp_.GetMemoryInfo();
-                auto it = memoryInfo.find(memory_id);
-                if (it != memoryInfo.end()) {
-                    size_t startBlock = it->second.first;
-                    size_t blockCount = it->second.second;
-                    const auto& meta = smp_.GetMeta(startBlock);
-                    std::ostringstream oss;
-                    oss << "Memory ID: " << memory_id << "\n";
-                    oss << "Description: " << meta.description << "\n";
-                    oss << "Blocks: " << startBlock << "-" << (startBlock + blockCount - 1) << "\n";
-                    oss << "----------------------------------------\n";
-                    oss << content;
-                    if (!content.empty() && content.back() != '\n') {
-                        oss << "\n";
-                    }
-                    oss << "----------------------------------------\n";
-                    oss << "Size: " << content.size() << " bytes\n";
-                    oss << "Last Modified: " << smp_.GetMemoryLastModifiedTimeString(memory_id)
-                        << "\n";
-                    resp.data = oss.str();
+                const std::string& content = snapshot.content;
+                size_t startBlock = snapshot.start_block;
+                size_t blockCount = snapshot.block_count;
+                std::ostringstream oss;
+                oss << "Memory ID: " << memory_id << "\n";
+                oss << "Description: " << snapshot.description << "\n";
+                if (snapshot.slab_slot >= 0) {
+                    oss << "Blocks: " << startBlock << " (slot " << snapshot.slab_slot << ", "
+                        << snapshot.slot_size << "B slab)\n";
                 } else {
-                    resp.data = content;
+                    oss << "Blocks: " << startBlock << "-" << (startBlock + blockCount - 1)
+                        << "\n";
+                }
+                oss << "----------------------------------------\n";
+                oss << content;
+                if (!content.empty() && content.back() != '\n') {
+                    oss << "\n";
                 }
+                oss << "----------------------------------------\n";
+                oss << "Size: " << content.size() << " bytes\n";
+                oss << "Last Modified: "
+                    << SharedMemoryPool::FormatModifiedTime(snapshot.last_modified) << "\n";
+                resp.data = oss.str();
             }
             break;
         }
 
         case Protocol::CommandType::STATUS: {
             // 返回所有内存块的状态信息（与 commands.cpp 格式一致）
-            const auto& memoryInfo = smp_.GetMemoryInfo();
-            if (memoryInfo.empty()) {
+            const auto records = smp_.GetAllocationsByStart();
+            if (records.empty()) {
                 resp.data =
                     "Memory Pool Status:\n|    MemoryID    |    Description    |      Bytes      | "
                     "                range                    |    Last Modified    "
@@ -451,35 +454,34 @@ void TCPServer::ProcessRequest(SOCKET clientSocket, const Protocol::Request& req
                 oss << "|----------------|-------------------|-----------------|-------------------"
                        "--------------------------|---------------------|\n";
 
-                // 使用指针避免复制数据，按起始 block 排序
-                std::vector<const std::pair<const std::string, std::pair<size_t, size_t>>*>
-                    sortedEntries;
-                sortedEntries.reserve(memoryInfo.size());
-                for (const auto& entry : memoryInfo) {
-                    sortedEntries.push_back(&entry);
-                }
-                std::sort(
-                    sortedEntries.begin(), sortedEntries.end(),
-                    [](const auto* a, const auto* b) { return a->second.first < b->second.first; });
-
-                for (const auto* entry : sortedEntries) {
-                    size_t blockCount = entry->second.second;
-                    size_t totalBytes = blockCount * SharedMemoryPool::kBlockSize;
+                // 分配记录已按起始 block 排序
+                for (const auto* record : records) {
+                    size_t blockCount = record->block_count;
+                    size_t totalBytes = blockCount * smp_.GetBlockSize();
                     size_t totalKB = totalBytes / 1024;
 
                     std::ostringstream rangeStream;
-                    rangeStream << "block_" << std::setfill('0') << std::setw(3)
-                                << entry->second.first << " - "
-                                << "block_" << std::setfill('0') << std::setw(3)
-                                << (entry->second.first + entry->second.second - 1) << "("
-                                << blockCount << " blocks, " << totalKB << "KB)";
+                    size_t slot = 0;
+                    size_t slotSize = 0;
+                    if (smp_.GetSlabSlot(record->memory_id, slot, slotSize)) {
+                        rangeStream << "block_" << std::setfill('0') << std::setw(3)
+                                    << record->start_block << " slot " << slot << "(" << slotSize
+                                    << "B slab)";
+                    } else {
+                        rangeStream << "block_" << std::setfill('0') << std::setw(3)
+                                    << record->start_block << " - "
+                                    << "block_" << std::setfill('0') << std::setw(3)
+                                    << (record->start_block + blockCount - 1) << "(" << blockCount
+                                    << " blocks, " << totalKB << "KB)";
+                    }
                     std::string rangeStr = rangeStream.str();
-                    const auto& meta = smp_.GetMeta(entry->second.first);
-                    std::string description = meta.description.empty() ? "-" : meta.description;
+                    std::string description = record->description;
+                    if (description.empty()) {
+                        description = "-";
+                    }
 
-                    // 计算实际字节数（通过读取内容）
-                    std::string content = smp_.GetMemoryContentAsString(entry->first);
-                    size_t bytes = content.size();
+                    // 实际字节数（分配记录中保存）
+                    size_t bytes = record->byte_length;
 
                     // 格式化字节数
                     std::ostringstream bytesStream;
@@ -487,13 +489,13 @@ void TCPServer::ProcessRequest(SOCKET clientSocket, const Protocol::Request& req
                     std::string bytesStr = bytesStream.str();
 
                     // 使用显示宽度进行截断和填充（支持中文）
-                    std::string memoryId = PadToDisplayWidth(entry->first, 14);
+                    std::string memoryId = PadToDisplayWidth(record->memory_id, 14);
                     description = TruncateToDisplayWidth(description, 17);
                     description = PadToDisplayWidth(description, 17);
                     std::string bytesFormatted = PadToDisplayWidth(bytesStr, 15);
                     std::string range = PadToDisplayWidth(rangeStr, 44);
-                    std::string lastModified =
-                        PadToDisplayWidth(smp_.GetMemoryLastModifiedTimeString(entry->first), 19);
+                    std::string lastModified = PadToDisplayWidth(
+                        smp_.GetMemoryLastModifiedTimeString(record->memory_id), 19);
 
                     oss << "| " << memoryId << " | " << description << " | " << bytesFormatted
                         << " | " << range << " | " << lastModified << " |\n";
@@ -39,6 +39,11 @@ class TCPServer {
         return running_;
     }
 
+    // 多 NUMA 节点时把连接线程轮流固定到各节点的 CPU 上（在 Start 之前设置）
+    void SetWorkerNodePinning(bool enable) {
+        pinWorkers_ = enable;
+    }
+
   private:
     // 客户端连接处理函数（每个连接一个线程）
     void HandleClient(SOCKET clientSocket, const std::string& clientIP, uint16_t clientPort);
@@ -60,4 +65,6 @@ class TCPServer {
     std::atomic<bool> running_;              // 服务器运行状态
     std::vector<std::thread> clientThreads_; // 客户端处理线程
     std::mutex threadsMutex_;                // 线程列表互斥锁
+    bool pinWorkers_ = false;                // 是否按 NUMA 节点固定连接线程
+    size_t nextWorkerNode_ = 0;              // 下一个连接线程固定到的节点
 };